@@ -0,0 +1,192 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+    // Двунаправленный поиск Дейкстры: прямой поиск от начала по исходящим рёбрам и
+    // обратный от цели по входящим идут попеременно, каждый раз шагает тот, у кого
+    // меньше вершина очереди. Лучший найденный путь через общую вершину окончателен,
+    // как только сумма вершин обеих очередей не меньше его веса.
+    // Предрасчёта нет, буферы размера V переиспользуются между запросами
+    template <typename Weight>
+    class BidirectionalDijkstraRouter : public RouterBase<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+        explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    private:
+        struct QueueItem {
+            Weight weight;
+            VertexId vertex;
+
+            bool operator>(const QueueItem& other) const {
+                return weight > other.weight;
+            }
+        };
+
+        // Буферы одного направления поиска
+        struct SearchSpace {
+            std::vector<std::optional<Weight>> weights;
+            std::vector<std::optional<EdgeId>> prev_edges;
+            std::vector<VertexId> touched_vertices;
+            std::vector<QueueItem> queue;
+
+            void Reset();
+            void Reach(VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge);
+            // Убирает устаревшие записи с вершины очереди
+            const QueueItem* Top();
+        };
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+
+        mutable SearchSpace forward_search_;
+        mutable SearchSpace backward_search_;
+    };
+
+    template <typename Weight>
+    void BidirectionalDijkstraRouter<Weight>::SearchSpace::Reset() {
+        for (const VertexId vertex : touched_vertices) {
+            weights[vertex].reset();
+            prev_edges[vertex].reset();
+        }
+        touched_vertices.clear();
+        queue.clear();
+    }
+
+    template <typename Weight>
+    void BidirectionalDijkstraRouter<Weight>::SearchSpace::Reach(VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge) {
+        if (!weights[vertex]) {
+            touched_vertices.push_back(vertex);
+        }
+        weights[vertex] = weight;
+        prev_edges[vertex] = prev_edge;
+        queue.push_back({ weight, vertex });
+        std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+    }
+
+    template <typename Weight>
+    const typename BidirectionalDijkstraRouter<Weight>::QueueItem* BidirectionalDijkstraRouter<Weight>::SearchSpace::Top() {
+        while (!queue.empty() && *weights[queue.front().vertex] < queue.front().weight) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+            queue.pop_back();
+        }
+        return queue.empty() ? nullptr : &queue.front();
+    }
+
+    template <typename Weight>
+    BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+        : graph_(graph)
+    {
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+        for (SearchSpace* search : { &forward_search_, &backward_search_ }) {
+            search->weights.resize(graph.GetVertexCount());
+            search->prev_edges.resize(graph.GetVertexCount());
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo> BidirectionalDijkstraRouter<Weight>::BuildRoute(VertexId from,
+        VertexId to) const {
+        if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        forward_search_.Reset();
+        backward_search_.Reset();
+        forward_search_.Reach(from, ZERO_WEIGHT, std::nullopt);
+        backward_search_.Reach(to, ZERO_WEIGHT, std::nullopt);
+
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+        const auto update_best = [&](VertexId vertex) {
+            if (forward_search_.weights[vertex] && backward_search_.weights[vertex]) {
+                const Weight weight = *forward_search_.weights[vertex] + *backward_search_.weights[vertex];
+                if (!best_weight || weight < *best_weight) {
+                    best_weight = weight;
+                    meeting_vertex = vertex;
+                }
+            }
+        };
+        update_best(from);
+
+        // Если одна из очередей опустела, все пути через её сторону уже учтены
+        while (true) {
+            const QueueItem* forward_top = forward_search_.Top();
+            const QueueItem* backward_top = backward_search_.Top();
+            if (!forward_top || !backward_top
+                || (best_weight && !(forward_top->weight + backward_top->weight < *best_weight))) {
+                break;
+            }
+
+            const bool forward = !(backward_top->weight < forward_top->weight);
+            SearchSpace& search = forward ? forward_search_ : backward_search_;
+            std::pop_heap(search.queue.begin(), search.queue.end(), std::greater<QueueItem>{});
+            const QueueItem item = search.queue.back();
+            search.queue.pop_back();
+
+            if (forward) {
+                for (const EdgeId edge_id : graph_.GetIncidentEdges(item.vertex)) {
+                    const VertexId target = graph_.GetEdgeTarget(edge_id);
+                    const Weight candidate_weight = item.weight + graph_.GetEdgeWeight(edge_id);
+                    if (!search.weights[target] || candidate_weight < *search.weights[target]) {
+                        search.Reach(target, candidate_weight, edge_id);
+                        update_best(target);
+                    }
+                }
+            }
+            else {
+                for (const EdgeId edge_id : graph_.GetIncomingEdges(item.vertex)) {
+                    const VertexId source = graph_.GetEdgeSource(edge_id);
+                    const Weight candidate_weight = item.weight + graph_.GetEdgeWeight(edge_id);
+                    if (!search.weights[source] || candidate_weight < *search.weights[source]) {
+                        search.Reach(source, candidate_weight, edge_id);
+                        update_best(source);
+                    }
+                }
+            }
+        }
+
+        if (!best_weight) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = forward_search_.prev_edges[meeting_vertex];
+            edge_id;
+            edge_id = forward_search_.prev_edges[graph_.GetEdgeSource(*edge_id)])
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        for (std::optional<EdgeId> edge_id = backward_search_.prev_edges[meeting_vertex];
+            edge_id;
+            edge_id = backward_search_.prev_edges[graph_.GetEdgeTarget(*edge_id)])
+        {
+            edges.push_back(*edge_id);
+        }
+
+        return RouteInfo{ *forward_search_.weights[meeting_vertex] + *backward_search_.weights[meeting_vertex], std::move(edges) };
+    }
+
+}  // namespace graph
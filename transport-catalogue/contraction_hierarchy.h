@@ -0,0 +1,502 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Маршрутизатор на иерархии сокращений (contraction hierarchies).
+    // Предрасчёт по очереди «стягивает» вершины от наименее важных к наиболее важным и
+    // добавляет рёбра-сокращения, сохраняющие кратчайшие пути между оставшимися вершинами.
+    // Запрос - двунаправленный поиск, который ходит только вверх по рангам вершин.
+    // Сокращения в найденном пути раскрываются обратно в рёбра исходного графа
+    template <typename Weight>
+    class ContractionHierarchy : public RouterBase<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+        // Сокращение from -> to заменяет пару рёбер first и second.
+        // Номера рёбер сквозные: меньше GetEdgeCount() - рёбра графа, дальше - сокращения по порядку
+        struct Shortcut {
+            VertexId from;
+            VertexId to;
+            Weight weight;
+            EdgeId first;
+            EdgeId second;
+        };
+
+        struct Hierarchy {
+            std::vector<uint32_t> ranks;
+            std::vector<Shortcut> shortcuts;
+        };
+
+        // Строит иерархию по графу
+        explicit ContractionHierarchy(const Graph& graph);
+        // Восстанавливает ранее построенную иерархию
+        ContractionHierarchy(const Graph& graph, Hierarchy hierarchy);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        const Hierarchy& GetHierarchy() const;
+
+    private:
+        struct Arc {
+            VertexId vertex;
+            Weight weight;
+            EdgeId edge_id;
+        };
+
+        struct QueueItem {
+            Weight weight;
+            VertexId vertex;
+
+            bool operator>(const QueueItem& other) const {
+                return weight > other.weight;
+            }
+        };
+
+        // Буферы одного направления поиска
+        struct SearchSpace {
+            std::vector<std::optional<Weight>> weights;
+            std::vector<EdgeId> parent_edges;
+            std::vector<VertexId> touched_vertices;
+            std::vector<QueueItem> queue;
+
+            void Reset();
+            void Reach(VertexId vertex, Weight weight, EdgeId parent_edge);
+            std::optional<QueueItem> PopActual();
+        };
+
+        // Граф из ещё не стянутых вершин во время предрасчёта
+        struct ContractionState {
+            std::vector<std::vector<Arc>> out_arcs;
+            std::vector<std::vector<Arc>> in_arcs;
+            std::vector<size_t> contracted_neighbors;
+            SearchSpace witness_search;
+        };
+
+        void Contract();
+        int64_t GetPriority(ContractionState& state, VertexId vertex);
+        size_t ContractVertex(ContractionState& state, VertexId vertex, bool simulate);
+        void RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded, Weight max_weight);
+        void AddShortcut(ContractionState& state, const Arc& in_arc, const Arc& out_arc);
+        void BuildSearchGraph();
+
+        std::pair<VertexId, VertexId> GetEdgeEnds(EdgeId edge_id) const;
+        Weight GetEdgeWeight(EdgeId edge_id) const;
+        void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+        // Поиск свидетеля ограничен: лишнее сокращение не портит ответы, а предрасчёт ускоряет
+        static constexpr size_t WITNESS_SETTLED_LIMIT = 500;
+
+        const Graph& graph_;
+        Hierarchy hierarchy_;
+
+        // Рёбра вверх по рангу: исходящие для прямого поиска, входящие для обратного (CSR)
+        std::vector<size_t> up_offsets_;
+        std::vector<Arc> up_arcs_;
+        std::vector<size_t> down_offsets_;
+        std::vector<Arc> down_arcs_;
+
+        mutable SearchSpace forward_search_;
+        mutable SearchSpace backward_search_;
+    };
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::SearchSpace::Reset() {
+        for (const VertexId vertex : touched_vertices) {
+            weights[vertex].reset();
+            parent_edges[vertex] = NO_EDGE;
+        }
+        touched_vertices.clear();
+        queue.clear();
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::SearchSpace::Reach(VertexId vertex, Weight weight, EdgeId parent_edge) {
+        if (!weights[vertex]) {
+            touched_vertices.push_back(vertex);
+        }
+        weights[vertex] = weight;
+        parent_edges[vertex] = parent_edge;
+        queue.push_back({ weight, vertex });
+        std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchy<Weight>::QueueItem> ContractionHierarchy<Weight>::SearchSpace::PopActual() {
+        while (!queue.empty()) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+            const QueueItem item = queue.back();
+            queue.pop_back();
+            if (!(*weights[item.vertex] < item.weight)) {
+                return item;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+        : graph_(graph)
+    {
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        Contract();
+        BuildSearchGraph();
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, Hierarchy hierarchy)
+        : graph_(graph)
+        , hierarchy_(std::move(hierarchy))
+    {
+        if (hierarchy_.ranks.size() != graph.GetVertexCount()) {
+            throw std::invalid_argument("Hierarchy doesn't match the graph");
+        }
+        BuildSearchGraph();
+    }
+
+    template <typename Weight>
+    int64_t ContractionHierarchy<Weight>::GetPriority(ContractionState& state, VertexId vertex) {
+        // Разность рёбер: сколько сокращений добавится минус сколько рёбер исчезнет,
+        // плюс число уже стянутых соседей, чтобы стягивание шло равномерно по графу
+        const int64_t shortcut_count = static_cast<int64_t>(ContractVertex(state, vertex, true));
+        const int64_t removed_count = static_cast<int64_t>(state.in_arcs[vertex].size() + state.out_arcs[vertex].size());
+        return shortcut_count - removed_count + static_cast<int64_t>(state.contracted_neighbors[vertex]);
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Contract() {
+        const size_t vertex_count = graph_.GetVertexCount();
+
+        ContractionState state;
+        state.out_arcs.resize(vertex_count);
+        state.in_arcs.resize(vertex_count);
+        state.contracted_neighbors.assign(vertex_count, 0);
+        state.witness_search.weights.resize(vertex_count);
+        state.witness_search.parent_edges.assign(vertex_count, NO_EDGE);
+
+        // Из параллельных рёбер в рабочем графе остаётся самое лёгкое
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (edge.from == edge.to) {
+                continue;
+            }
+            auto& out_arcs = state.out_arcs[edge.from];
+            const auto it = std::find_if(out_arcs.begin(), out_arcs.end(),
+                [&edge](const Arc& arc) { return arc.vertex == edge.to; });
+            if (it == out_arcs.end()) {
+                out_arcs.push_back({ edge.to, edge.weight, edge_id });
+                state.in_arcs[edge.to].push_back({ edge.from, edge.weight, edge_id });
+            }
+            else if (edge.weight < it->weight) {
+                *it = { edge.to, edge.weight, edge_id };
+                for (Arc& arc : state.in_arcs[edge.to]) {
+                    if (arc.vertex == edge.from) {
+                        arc = { edge.from, edge.weight, edge_id };
+                    }
+                }
+            }
+        }
+
+        using PriorityItem = std::pair<int64_t, VertexId>;
+        std::vector<PriorityItem> priority_queue;
+        priority_queue.reserve(vertex_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            priority_queue.push_back({ GetPriority(state, vertex), vertex });
+        }
+        std::make_heap(priority_queue.begin(), priority_queue.end(), std::greater<PriorityItem>{});
+
+        hierarchy_.ranks.assign(vertex_count, 0);
+        uint32_t next_rank = 0;
+        while (!priority_queue.empty()) {
+            std::pop_heap(priority_queue.begin(), priority_queue.end(), std::greater<PriorityItem>{});
+            const VertexId vertex = priority_queue.back().second;
+            priority_queue.pop_back();
+
+            // Ленивое обновление: приоритет мог вырасти после стягивания соседей
+            const int64_t priority = GetPriority(state, vertex);
+            if (!priority_queue.empty() && priority > priority_queue.front().first) {
+                priority_queue.push_back({ priority, vertex });
+                std::push_heap(priority_queue.begin(), priority_queue.end(), std::greater<PriorityItem>{});
+                continue;
+            }
+
+            ContractVertex(state, vertex, false);
+            hierarchy_.ranks[vertex] = next_rank++;
+
+            for (const Arc& in_arc : state.in_arcs[vertex]) {
+                auto& out_arcs = state.out_arcs[in_arc.vertex];
+                out_arcs.erase(std::remove_if(out_arcs.begin(), out_arcs.end(),
+                    [vertex](const Arc& arc) { return arc.vertex == vertex; }), out_arcs.end());
+                ++state.contracted_neighbors[in_arc.vertex];
+            }
+            for (const Arc& out_arc : state.out_arcs[vertex]) {
+                auto& in_arcs = state.in_arcs[out_arc.vertex];
+                in_arcs.erase(std::remove_if(in_arcs.begin(), in_arcs.end(),
+                    [vertex](const Arc& arc) { return arc.vertex == vertex; }), in_arcs.end());
+                ++state.contracted_neighbors[out_arc.vertex];
+            }
+            state.in_arcs[vertex].clear();
+            state.out_arcs[vertex].clear();
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::RunWitnessSearch(ContractionState& state, VertexId source, VertexId excluded, Weight max_weight) {
+        SearchSpace& search = state.witness_search;
+        search.Reset();
+        search.Reach(source, ZERO_WEIGHT, NO_EDGE);
+
+        size_t settled_count = 0;
+        while (const auto item = search.PopActual()) {
+            if (max_weight < item->weight || ++settled_count > WITNESS_SETTLED_LIMIT) {
+                break;
+            }
+            for (const Arc& arc : state.out_arcs[item->vertex]) {
+                if (arc.vertex == excluded) {
+                    continue;
+                }
+                const Weight candidate_weight = item->weight + arc.weight;
+                if (!search.weights[arc.vertex] || candidate_weight < *search.weights[arc.vertex]) {
+                    search.Reach(arc.vertex, candidate_weight, arc.edge_id);
+                }
+            }
+        }
+    }
+
+    template <typename Weight>
+    size_t ContractionHierarchy<Weight>::ContractVertex(ContractionState& state, VertexId vertex, bool simulate) {
+        size_t shortcut_count = 0;
+        // Копия: при добавлении сокращений списки соседей меняются
+        const std::vector<Arc> in_arcs = state.in_arcs[vertex];
+        const std::vector<Arc> out_arcs = state.out_arcs[vertex];
+
+        for (const Arc& in_arc : in_arcs) {
+            Weight max_weight = ZERO_WEIGHT;
+            for (const Arc& out_arc : out_arcs) {
+                max_weight = std::max(max_weight, in_arc.weight + out_arc.weight);
+            }
+            RunWitnessSearch(state, in_arc.vertex, vertex, max_weight);
+
+            for (const Arc& out_arc : out_arcs) {
+                if (out_arc.vertex == in_arc.vertex) {
+                    continue;
+                }
+                const Weight weight = in_arc.weight + out_arc.weight;
+                const auto& witness_weight = state.witness_search.weights[out_arc.vertex];
+                if (witness_weight && !(weight < *witness_weight)) {
+                    continue;
+                }
+                ++shortcut_count;
+                if (!simulate) {
+                    AddShortcut(state, in_arc, out_arc);
+                }
+            }
+        }
+        return shortcut_count;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::AddShortcut(ContractionState& state, const Arc& in_arc, const Arc& out_arc) {
+        const VertexId from = in_arc.vertex;
+        const VertexId to = out_arc.vertex;
+        const Weight weight = in_arc.weight + out_arc.weight;
+        const EdgeId edge_id = graph_.GetEdgeCount() + hierarchy_.shortcuts.size();
+        hierarchy_.shortcuts.push_back({ from, to, weight, in_arc.edge_id, out_arc.edge_id });
+
+        auto& out_arcs = state.out_arcs[from];
+        const auto it = std::find_if(out_arcs.begin(), out_arcs.end(),
+            [to](const Arc& arc) { return arc.vertex == to; });
+        if (it == out_arcs.end()) {
+            out_arcs.push_back({ to, weight, edge_id });
+            state.in_arcs[to].push_back({ from, weight, edge_id });
+            return;
+        }
+        *it = { to, weight, edge_id };
+        for (Arc& arc : state.in_arcs[to]) {
+            if (arc.vertex == from) {
+                arc = { from, weight, edge_id };
+            }
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::BuildSearchGraph() {
+        const size_t vertex_count = graph_.GetVertexCount();
+        const size_t edge_count = graph_.GetEdgeCount() + hierarchy_.shortcuts.size();
+        const auto& ranks = hierarchy_.ranks;
+
+        up_offsets_.assign(vertex_count + 1, 0);
+        down_offsets_.assign(vertex_count + 1, 0);
+        for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            const auto [from, to] = GetEdgeEnds(edge_id);
+            if (ranks[from] < ranks[to]) {
+                ++up_offsets_[from + 1];
+            }
+            else if (ranks[to] < ranks[from]) {
+                ++down_offsets_[to + 1];
+            }
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            up_offsets_[vertex + 1] += up_offsets_[vertex];
+            down_offsets_[vertex + 1] += down_offsets_[vertex];
+        }
+
+        std::vector<size_t> up_positions(up_offsets_.begin(), up_offsets_.end() - 1);
+        std::vector<size_t> down_positions(down_offsets_.begin(), down_offsets_.end() - 1);
+        up_arcs_.resize(up_offsets_.back());
+        down_arcs_.resize(down_offsets_.back());
+        for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            const auto [from, to] = GetEdgeEnds(edge_id);
+            if (ranks[from] < ranks[to]) {
+                up_arcs_[up_positions[from]++] = { to, GetEdgeWeight(edge_id), edge_id };
+            }
+            else if (ranks[to] < ranks[from]) {
+                down_arcs_[down_positions[to]++] = { from, GetEdgeWeight(edge_id), edge_id };
+            }
+        }
+
+        for (SearchSpace* search : { &forward_search_, &backward_search_ }) {
+            search->weights.assign(vertex_count, std::nullopt);
+            search->parent_edges.assign(vertex_count, NO_EDGE);
+        }
+    }
+
+    template <typename Weight>
+    std::pair<VertexId, VertexId> ContractionHierarchy<Weight>::GetEdgeEnds(EdgeId edge_id) const {
+        if (edge_id < graph_.GetEdgeCount()) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            return { edge.from, edge.to };
+        }
+        const Shortcut& shortcut = hierarchy_.shortcuts[edge_id - graph_.GetEdgeCount()];
+        return { shortcut.from, shortcut.to };
+    }
+
+    template <typename Weight>
+    Weight ContractionHierarchy<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+        if (edge_id < graph_.GetEdgeCount()) {
+            return graph_.GetEdgeWeight(edge_id);
+        }
+        return hierarchy_.shortcuts[edge_id - graph_.GetEdgeCount()].weight;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+        std::vector<EdgeId> stack{ edge_id };
+        while (!stack.empty()) {
+            const EdgeId current = stack.back();
+            stack.pop_back();
+            if (current < graph_.GetEdgeCount()) {
+                edges.push_back(current);
+                continue;
+            }
+            const Shortcut& shortcut = hierarchy_.shortcuts[current - graph_.GetEdgeCount()];
+            stack.push_back(shortcut.second);
+            stack.push_back(shortcut.first);
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from,
+        VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        forward_search_.Reset();
+        backward_search_.Reset();
+        forward_search_.Reach(from, ZERO_WEIGHT, NO_EDGE);
+        backward_search_.Reach(to, ZERO_WEIGHT, NO_EDGE);
+
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+
+        // Поиски чередуются; направление заканчивается, когда его минимум не меньше лучшего пути
+        bool forward = true;
+        bool forward_done = false;
+        bool backward_done = false;
+        while (!forward_done || !backward_done) {
+            if (forward ? forward_done : backward_done) {
+                forward = !forward;
+                continue;
+            }
+            SearchSpace& search = forward ? forward_search_ : backward_search_;
+            const SearchSpace& opposite = forward ? backward_search_ : forward_search_;
+
+            const auto item = search.PopActual();
+            if (!item || (best_weight && !(item->weight < *best_weight))) {
+                (forward ? forward_done : backward_done) = true;
+                forward = !forward;
+                continue;
+            }
+
+            if (const auto& opposite_weight = opposite.weights[item->vertex]) {
+                const Weight weight = item->weight + *opposite_weight;
+                if (!best_weight || weight < *best_weight) {
+                    best_weight = weight;
+                    meeting_vertex = item->vertex;
+                }
+            }
+
+            const auto& offsets = forward ? up_offsets_ : down_offsets_;
+            const auto& arcs = forward ? up_arcs_ : down_arcs_;
+            for (size_t i = offsets[item->vertex]; i < offsets[item->vertex + 1]; ++i) {
+                const Arc& arc = arcs[i];
+                const Weight candidate_weight = item->weight + arc.weight;
+                if (!search.weights[arc.vertex] || candidate_weight < *search.weights[arc.vertex]) {
+                    search.Reach(arc.vertex, candidate_weight, arc.edge_id);
+                }
+            }
+            forward = !forward;
+        }
+
+        if (!best_weight) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> path_edges;
+        for (VertexId vertex = meeting_vertex; vertex != from;) {
+            const EdgeId edge_id = forward_search_.parent_edges[vertex];
+            path_edges.push_back(edge_id);
+            vertex = GetEdgeEnds(edge_id).first;
+        }
+        std::reverse(path_edges.begin(), path_edges.end());
+        for (VertexId vertex = meeting_vertex; vertex != to;) {
+            const EdgeId edge_id = backward_search_.parent_edges[vertex];
+            path_edges.push_back(edge_id);
+            vertex = GetEdgeEnds(edge_id).second;
+        }
+
+        std::vector<EdgeId> edges;
+        for (const EdgeId edge_id : path_edges) {
+            UnpackEdge(edge_id, edges);
+        }
+
+        return RouteInfo{ *best_weight, std::move(edges) };
+    }
+
+    template <typename Weight>
+    const typename ContractionHierarchy<Weight>::Hierarchy& ContractionHierarchy<Weight>::GetHierarchy() const {
+        return hierarchy_;
+    }
+
+}  // namespace graph
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "router.h"
+#include "priority_queues.h"
+#include "shortest_path_tree_cache.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Поиск кратчайшего пути алгоритмом Дейкстры на каждый запрос.
+    // В отличие от Router не хранит таблицу V x V: между запросами переиспользуются
+    // только буферы размера V, которые сбрасываются по списку затронутых вершин.
+    // С потенциалом поиск становится A*: очередь упорядочена по весу плюс оценке
+    // остатка пути до цели. Оценка должна быть согласованной (не больше веса любого
+    // ребра плюс оценки из его конца), тогда первое извлечение цели даёт кратчайший путь.
+    // Queue - очередь с приоритетом из priority_queues.h.
+    // С кэшем (только без потенциала) поиск не останавливается на цели, а строит дерево
+    // кратчайших путей от начала целиком; следующие запросы из той же вершины читают его.
+    // Веса рёбер можно передать отдельно от графа (по номерам рёбер после Freeze): так один
+    // граф обслуживает поиски с разными параметрами маршрутизации
+    template <typename Weight, template <typename> class Queue = BinaryHeap>
+    class DijkstraRouter : public RouterBase<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+        // Нижняя оценка веса пути от вершины до цели
+        using Potential = std::function<Weight(VertexId vertex, VertexId target)>;
+
+        using TreeCache = ShortestPathTreeCache<Weight>;
+
+        explicit DijkstraRouter(const Graph& graph, Potential potential = {}, TreeCache* tree_cache = nullptr,
+            std::vector<Weight> edge_weights = {});
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        // Дерево кратчайших путей от from целиком и маршрут по готовому дереву:
+        // для запросов из одной вершины во многие хватает одного поиска
+        std::shared_ptr<const typename TreeCache::Tree> BuildTree(VertexId from) const;
+        std::optional<RouteInfo> BuildRouteFromTree(const typename TreeCache::Tree& tree, VertexId to) const;
+
+        // Все вершины, достижимые из from с весом не больше max_weight, и их веса (в произвольном
+        // порядке). Поиск не кладёт в очередь вершины дальше границы и заканчивается вместе с ней
+        std::vector<std::pair<VertexId, Weight>> BuildReachable(VertexId from, Weight max_weight) const;
+
+    private:
+        struct QueueItem {
+            Weight key;  // вес плюс потенциал вершины
+            Weight weight;
+            VertexId vertex;
+        };
+
+        Weight GetEdgeWeight(EdgeId edge_id) const {
+            return edge_weights_.empty() ? graph_.GetEdgeWeight(edge_id) : edge_weights_[edge_id];
+        }
+
+        void Reach(VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge) const;
+        void ResetScratch() const;
+        // Поиск от from; без target - до исчерпания очереди. Вершины с весом больше max_weight не достигаются
+        void RunSearch(VertexId from, std::optional<VertexId> target, std::optional<Weight> max_weight = std::nullopt) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        Potential potential_;
+        TreeCache* tree_cache_;
+        std::vector<Weight> edge_weights_;  // пустой - веса из графа
+
+        // Буферы поиска, общие для всех запросов
+        mutable VertexId target_ = 0;
+        mutable std::vector<Weight> potentials_;  // действительны для затронутых вершин
+        mutable std::vector<std::optional<Weight>> weights_;
+        mutable std::vector<std::optional<EdgeId>> prev_edges_;
+        mutable std::vector<VertexId> touched_vertices_;
+        mutable Queue<QueueItem> queue_;
+    };
+
+    template <typename Weight, template <typename> class Queue>
+    DijkstraRouter<Weight, Queue>::DijkstraRouter(const Graph& graph, Potential potential, TreeCache* tree_cache,
+        std::vector<Weight> edge_weights)
+        : graph_(graph)
+        , potential_(std::move(potential))
+        , tree_cache_(potential_ ? nullptr : tree_cache)
+        , edge_weights_(std::move(edge_weights))
+        , potentials_(potential_ ? graph.GetVertexCount() : 0)
+        , weights_(graph.GetVertexCount())
+        , prev_edges_(graph.GetVertexCount())
+    {
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        if (!edge_weights_.empty() && edge_weights_.size() != graph.GetEdgeCount()) {
+            throw std::invalid_argument("Edge weights don't match the graph");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    void DijkstraRouter<Weight, Queue>::Reach(VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge) const {
+        if (!weights_[vertex]) {
+            touched_vertices_.push_back(vertex);
+            if (potential_) {
+                potentials_[vertex] = potential_(vertex, target_);
+            }
+        }
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        queue_.Push({ potential_ ? weight + potentials_[vertex] : weight, weight, vertex });
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    void DijkstraRouter<Weight, Queue>::ResetScratch() const {
+        for (const VertexId vertex : touched_vertices_) {
+            weights_[vertex].reset();
+            prev_edges_[vertex].reset();
+        }
+        touched_vertices_.clear();
+        queue_.Clear();
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    void DijkstraRouter<Weight, Queue>::RunSearch(VertexId from, std::optional<VertexId> target, std::optional<Weight> max_weight) const {
+        ResetScratch();
+        target_ = target.value_or(from);
+        Reach(from, ZERO_WEIGHT, std::nullopt);
+
+        while (!queue_.IsEmpty()) {
+            const QueueItem item = queue_.Pop();
+
+            // Устаревшая запись очереди: вершина уже достигнута дешевле
+            if (*weights_[item.vertex] < item.weight) {
+                continue;
+            }
+            if (item.vertex == target) {
+                break;
+            }
+
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(item.vertex)) {
+                const VertexId next = graph_.GetEdgeTarget(edge_id);
+                const Weight candidate_weight = item.weight + GetEdgeWeight(edge_id);
+                if (max_weight && *max_weight < candidate_weight) {
+                    continue;
+                }
+                if (!weights_[next] || candidate_weight < *weights_[next]) {
+                    Reach(next, candidate_weight, edge_id);
+                }
+            }
+        }
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    std::shared_ptr<const typename DijkstraRouter<Weight, Queue>::TreeCache::Tree> DijkstraRouter<Weight, Queue>::BuildTree(VertexId from) const {
+        using Tree = typename TreeCache::Tree;
+        RunSearch(from, std::nullopt);
+
+        auto tree = std::make_shared<Tree>();
+        tree->weights.assign(weights_.size(), Tree::UNREACHABLE_WEIGHT);
+        tree->prev_edges.assign(weights_.size(), Tree::NO_EDGE);
+        for (const VertexId vertex : touched_vertices_) {
+            tree->weights[vertex] = *weights_[vertex];
+            if (prev_edges_[vertex]) {
+                tree->prev_edges[vertex] = static_cast<uint32_t>(*prev_edges_[vertex]);
+            }
+        }
+        return tree;
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    std::optional<typename DijkstraRouter<Weight, Queue>::RouteInfo> DijkstraRouter<Weight, Queue>::BuildRouteFromTree(
+        const typename TreeCache::Tree& tree, VertexId to) const {
+        if (tree.weights[to] == TreeCache::Tree::UNREACHABLE_WEIGHT) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> edges;
+        for (uint32_t edge_id = tree.prev_edges[to];
+            edge_id != TreeCache::Tree::NO_EDGE;
+            edge_id = tree.prev_edges[graph_.GetEdgeSource(edge_id)])
+        {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{ tree.weights[to], std::move(edges) };
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight, Queue>::BuildReachable(VertexId from, Weight max_weight) const {
+        if (from >= weights_.size()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        RunSearch(from, std::nullopt, max_weight);
+
+        std::vector<std::pair<VertexId, Weight>> reachable;
+        reachable.reserve(touched_vertices_.size());
+        for (const VertexId vertex : touched_vertices_) {
+            reachable.emplace_back(vertex, *weights_[vertex]);
+        }
+        return reachable;
+    }
+
+    template <typename Weight, template <typename> class Queue>
+    std::optional<typename DijkstraRouter<Weight, Queue>::RouteInfo> DijkstraRouter<Weight, Queue>::BuildRoute(VertexId from,
+        VertexId to) const {
+        if (from >= weights_.size() || to >= weights_.size()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+
+        if (tree_cache_) {
+            auto tree = tree_cache_->Find(from);
+            if (!tree) {
+                tree = BuildTree(from);
+                tree_cache_->Insert(from, tree);
+            }
+            return BuildRouteFromTree(*tree, to);
+        }
+
+        RunSearch(from, to);
+
+        if (!weights_[to]) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = prev_edges_[to];
+            edge_id;
+            edge_id = prev_edges_[graph_.GetEdgeSource(*edge_id)])
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{ *weights_[to], std::move(edges) };
+    }
+
+}  // namespace graph
@@ -1,6 +1,8 @@
 #pragma once
 #include "geo.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "deque"
@@ -15,6 +17,7 @@ namespace domain {
 	struct Stop {
 		std::string stop_name;
 		geo::Coordinates coordinates;
+		uint32_t id = 0;  // индекс в GetStops(), назначается справочником
 
 	};
 
@@ -34,17 +37,96 @@ namespace domain {
 
 
 
+	// Характеристики маршрута для запроса Bus: считаются один раз при создании базы и хранятся в ней
+	struct BusStats {
+		int stop_count = 0;
+		int unique_stop_count = 0;
+		int route_length = 0;  // по дорожным расстояниям, в метрах
+		double route_curvature = 0;  // отношение дорожной длины к географической
+	};
+
 	struct Bus {
 		std::string bus_name;
-		//std::deque<std::string*> stops;
-		std::deque<std::string_view> stops;
+		std::vector<uint32_t> stops;  // индексы остановок в GetStops()
 		std::string type;
+		uint32_t id = 0;  // индекс в GetBuses(), назначается справочником
+		// Дорожные расстояния участков: distances[i] - от stops[i] до stops[i + 1],
+		// return_distances[i] - то же для обратного пути некольцевого маршрута (остановки в обратном порядке).
+		// Заполняются справочником, когда добавлены все маршруты и расстояния
+		std::vector<int> distances;
+		std::vector<int> return_distances;
+		BusStats stats;
+	};
+
+	// Непрерывный диапазон индексов без владения (замена std::span до C++20)
+	class IdSpan {
+	public:
+		IdSpan() = default;
+		IdSpan(const uint32_t* first, const uint32_t* last)
+			: first_(first), last_(last) {
+		}
+
+		const uint32_t* begin() const { return first_; }
+		const uint32_t* end() const { return last_; }
+		size_t size() const { return last_ - first_; }
+		bool empty() const { return first_ == last_; }
+
+	private:
+		const uint32_t* first_ = nullptr;
+		const uint32_t* last_ = nullptr;
+	};
+
+	// Алгоритм поиска маршрута между остановками
+	enum class RouterType {
+		DIJKSTRA,     // поиск на каждый запрос, без предварительного расчёта
+		PRECOMPUTED,  // таблица кратчайших путей между всеми парами вершин
+		RAPTOR,       // поиск по раундам прямо по маршрутам автобусов, без графа
+		CONTRACTION_HIERARCHIES,  // иерархия сокращений, строится при make_base
+		ASTAR,        // A* с оценкой остатка пути по координатам остановок
+		BIDIRECTIONAL_DIJKSTRA,  // встречный поиск Дейкстры от начала и от цели
+		ALT           // A* с оценкой по расстояниям до опорных вершин, таблицы строятся при make_base
+	};
+
+	// Модель графа маршрутизации
+	enum class GraphModel {
+		STOP_PAIRS,    // ребро от каждой остановки маршрута до каждой следующей: O(n^2) рёбер на маршрут
+		LINE_SEGMENTS  // вершина на каждую позицию маршрута и рёбра между соседними: O(n) рёбер
+	};
+
+	// Очередь с приоритетом поисков DIJKSTRA, ASTAR и ALT
+	enum class QueueType {
+		BINARY_HEAP,  // двоичная куча
+		RADIX_HEAP    // монотонная поразрядная куча
+	};
+
+	// Параметры, из которых считаются веса рёбер графа. Граф хранит расстояния и число
+	// ожиданий, поэтому параметры можно задать в запросе, не перестраивая граф
+	struct RouteWeightParameters {
+		double bus_velocity = 40;
+		double bus_wait_time = 6;
+
+		bool operator==(const RouteWeightParameters& other) const {
+			return bus_velocity == other.bus_velocity && bus_wait_time == other.bus_wait_time;
+		}
+		bool operator!=(const RouteWeightParameters& other) const {
+			return !(*this == other);
+		}
 	};
 
 	struct RouteSettings {
-		double bus_velocity;
-		double bus_wait_time;
+		double bus_velocity = 40;
+		double bus_wait_time = 6;
+		RouterType router_type = RouterType::DIJKSTRA;
+		size_t router_threads = 1;  // потоки для расчёта таблицы PRECOMPUTED, 0 - по числу ядер
+		bool router_float_weights = false;  // хранить веса таблицы PRECOMPUTED во float
+		GraphModel graph_model = GraphModel::STOP_PAIRS;
+		size_t router_landmarks = 8;  // число опорных вершин маршрутизатора ALT
+		QueueType router_queue = QueueType::BINARY_HEAP;
+		size_t router_cache_bytes = 0;  // кэш деревьев кратчайших путей маршрутизатора DIJKSTRA, 0 - без кэша
 
+		RouteWeightParameters GetWeightParameters() const {
+			return { bus_velocity, bus_wait_time };
+		}
 	};
 
 	struct Distance {
@@ -3,10 +3,12 @@
 #include "ranges.h"
 #include "transport_catalogue.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
 #include <unordered_map>
 #include <iostream>
+#include <stdexcept>
 #include <string_view>
 
 namespace graph {
@@ -20,69 +22,209 @@ namespace graph {
         VertexId to;
         Weight weight;
 
-        std::string name;
+        uint32_t name_id;  // ожидание: индекс остановки в GetStops(), поездка: индекс автобуса в GetBuses()
         int stop_count;
+        // Из чего складывается вес: метры поездки и число ожиданий автобуса
+        int distance = 0;
+        int wait_count = 0;
 
         bool operator==(const Edge& other) const {
             return from == other.from && to == other.to && weight == other.weight;
         }
     };
 
+    // Граф строится в два этапа: сначала рёбра добавляются через AddEdge, затем Freeze
+    // переводит его в формат CSR (compressed sparse row). После заморозки рёбра каждой
+    // вершины лежат подряд. Поля рёбер хранятся отдельными массивами по номеру ребра:
+    // начала, концы, веса и остальные данные, нужные только для ответа; обход исходящих
+    // рёбер читает подряд лишь концы и веса. GetEdge собирает Edge из этих массивов.
+    // Freeze перенумеровывает рёбра по возрастанию вершины-начала, порядок добавления
+    // рёбер одной вершины сохраняется. Там же строится обратный индекс: номера рёбер,
+    // входящих в каждую вершину, для поисков от цели к началу
     template <typename Weight>
     class DirectedWeightedGraph {
     private:
-        using IncidenceList = std::vector<EdgeId>;
-        using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+        using IncidentEdgesRange = ranges::Range<ranges::CountingIterator<EdgeId>>;
+        using IncomingEdgesRange = ranges::Range<std::vector<EdgeId>::const_iterator>;
 
     public:
         DirectedWeightedGraph() = default;
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
+        void ReserveEdges(size_t edge_count);
+        void Freeze();
 
+        bool IsFrozen() const;
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
-        const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+        Edge<Weight> GetEdge(EdgeId edge_id) const;
+        // Доступны после Freeze
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+        IncomingEdgesRange GetIncomingEdges(VertexId vertex) const;
+        // Отдельные поля ребра без сборки Edge: для обходов и восстановления пути
+        VertexId GetEdgeSource(EdgeId edge_id) const;
+        VertexId GetEdgeTarget(EdgeId edge_id) const;
+        Weight GetEdgeWeight(EdgeId edge_id) const;
 
     private:
-        std::vector<Edge<Weight>> edges_;
-        std::vector<IncidenceList> incidence_lists_;
+        // Поля Edge, которые не читает поиск
+        struct EdgeMetadata {
+            uint32_t name_id;
+            int stop_count;
+            int distance;
+            int wait_count;
+        };
+
+        // Переставляет элементы: элемент i переходит на место new_positions[i]
+        template <typename T>
+        static void Permute(std::vector<T>& values, const std::vector<EdgeId>& new_positions);
+
+        size_t vertex_count_ = 0;
+        bool frozen_ = false;
+
+        std::vector<VertexId> sources_;
+        std::vector<VertexId> targets_;
+        std::vector<Weight> weights_;
+        std::vector<EdgeMetadata> metadata_;
+        std::vector<EdgeId> offsets_;
+        std::vector<EdgeId> incoming_offsets_;
+        std::vector<EdgeId> incoming_edges_;
     };
 
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-        : incidence_lists_(vertex_count) {
+        : vertex_count_(vertex_count) {
     }
 
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
-        edges_.push_back(edge);
-        const EdgeId id = edges_.size() - 1;
-        incidence_lists_.at(edge.from).push_back(id); 
-        return id;
+        if (frozen_) {
+            throw std::logic_error("Can't add an edge to a frozen graph");
+        }
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::out_of_range("Edge vertex is out of range");
+        }
+        sources_.push_back(edge.from);
+        targets_.push_back(edge.to);
+        weights_.push_back(edge.weight);
+        metadata_.push_back({ edge.name_id, edge.stop_count, edge.distance, edge.wait_count });
+        return sources_.size() - 1;
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::ReserveEdges(size_t edge_count) {
+        sources_.reserve(edge_count);
+        targets_.reserve(edge_count);
+        weights_.reserve(edge_count);
+        metadata_.reserve(edge_count);
+    }
+
+    template <typename Weight>
+    template <typename T>
+    void DirectedWeightedGraph<Weight>::Permute(std::vector<T>& values, const std::vector<EdgeId>& new_positions) {
+        std::vector<T> permuted(values.size());
+        for (EdgeId edge_id = 0; edge_id < values.size(); ++edge_id) {
+            permuted[new_positions[edge_id]] = std::move(values[edge_id]);
+        }
+        values = std::move(permuted);
+    }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::Freeze() {
+        if (frozen_) {
+            return;
+        }
+
+        // Сортировка подсчётом по вершине-началу
+        offsets_.assign(vertex_count_ + 1, 0);
+        for (const VertexId source : sources_) {
+            ++offsets_[source + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            offsets_[vertex + 1] += offsets_[vertex];
+        }
+
+        std::vector<EdgeId> positions(offsets_.begin(), offsets_.end() - 1);
+        std::vector<EdgeId> new_positions(sources_.size());
+        for (EdgeId edge_id = 0; edge_id < sources_.size(); ++edge_id) {
+            new_positions[edge_id] = positions[sources_[edge_id]]++;
+        }
+        Permute(sources_, new_positions);
+        Permute(targets_, new_positions);
+        Permute(weights_, new_positions);
+        Permute(metadata_, new_positions);
+
+        incoming_offsets_.assign(vertex_count_ + 1, 0);
+        for (const VertexId target : targets_) {
+            ++incoming_offsets_[target + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            incoming_offsets_[vertex + 1] += incoming_offsets_[vertex];
+        }
+
+        positions.assign(incoming_offsets_.begin(), incoming_offsets_.end() - 1);
+        incoming_edges_.resize(targets_.size());
+        for (EdgeId edge_id = 0; edge_id < targets_.size(); ++edge_id) {
+            incoming_edges_[positions[targets_[edge_id]]++] = edge_id;
+        }
+
+        frozen_ = true;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+        return frozen_;
     }
 
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-        return incidence_lists_.size();
+        return vertex_count_;
     }
 
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-        return edges_.size();
+        return sources_.size();
     }
 
     template <typename Weight>
-    const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-        return edges_.at(edge_id);
+    Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+        const EdgeMetadata& metadata = metadata_.at(edge_id);
+        return { sources_[edge_id], targets_[edge_id], weights_[edge_id],
+                 metadata.name_id, metadata.stop_count, metadata.distance, metadata.wait_count };
     }
 
     template <typename Weight>
     typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
         DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-        return ranges::AsRange(incidence_lists_.at(vertex));
+        if (!frozen_) {
+            throw std::logic_error("Graph should be frozen before traversal");
+        }
+        return ranges::Iota(offsets_.at(vertex), offsets_.at(vertex + 1));
     }
 
+    template <typename Weight>
+    typename DirectedWeightedGraph<Weight>::IncomingEdgesRange
+        DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+        if (!frozen_) {
+            throw std::logic_error("Graph should be frozen before traversal");
+        }
+        return { incoming_edges_.begin() + incoming_offsets_.at(vertex),
+                 incoming_edges_.begin() + incoming_offsets_.at(vertex + 1) };
+    }
 
+    template <typename Weight>
+    VertexId DirectedWeightedGraph<Weight>::GetEdgeSource(EdgeId edge_id) const {
+        return sources_[edge_id];
+    }
+
+    template <typename Weight>
+    VertexId DirectedWeightedGraph<Weight>::GetEdgeTarget(EdgeId edge_id) const {
+        return targets_[edge_id];
+    }
+
+    template <typename Weight>
+    Weight DirectedWeightedGraph<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+        return weights_[edge_id];
+    }
 
-}  // namespace graph  
\ No newline at end of file
+}  // namespace graph
\ No newline at end of file
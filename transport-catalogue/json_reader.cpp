@@ -5,6 +5,9 @@
 #include "json_reader.h"
 #include "json_builder.h"
 
+#include <cmath>
+#include <limits>
+
 
 
 
@@ -94,6 +97,31 @@ namespace transport_catalogue {
 
 	}
 
+	// Необязательный словарь routing_settings запросов маршрутов: bus_velocity и bus_wait_time.
+	// Скорость не больше нуля или отрицательное ожидание дают бесконечные или отрицательные
+	// веса рёбер, поэтому такой запрос отклоняется и до маршрутизатора не доходит
+	void ReadRouteWeightOverrides(const json::Dict& json_obj, OutputRequest& request) {
+		if (json_obj.find("routing_settings") == json_obj.end()) {
+			return;
+		}
+		const auto& settings = json_obj.at("routing_settings").AsDict();
+		std::optional<double> bus_velocity;
+		std::optional<double> bus_wait_time;
+		if (settings.find("bus_velocity") != settings.end()) {
+			bus_velocity = settings.at("bus_velocity").AsDouble();
+		}
+		if (settings.find("bus_wait_time") != settings.end()) {
+			bus_wait_time = settings.at("bus_wait_time").AsDouble();
+		}
+		// !(x > 0) отклоняет и NaN
+		if ((bus_velocity && !(*bus_velocity > 0)) || (bus_wait_time && !(*bus_wait_time >= 0))) {
+			request.error_message = "invalid routing_settings"s;
+			return;
+		}
+		request.bus_velocity = bus_velocity;
+		request.bus_wait_time = bus_wait_time;
+	}
+
 	void InputReaderJson::ReadInputJsonStatRequest() {
 		const auto& json_array_out = ((load_.GetRoot()).AsDict()).at("stat_requests"s);
 		if (!json_array_out.IsNull()) {
@@ -110,6 +138,33 @@ namespace transport_catalogue {
 					outputstopjson.type = json_obj.at("type").AsString();
 					outputstopjson.from = json_obj.at("from").AsString();
 					outputstopjson.to = json_obj.at("to").AsString();
+					ReadRouteWeightOverrides(json_obj, outputstopjson);
+					out_req_.push_back(outputstopjson);
+				}
+				else if (json_obj.at("type").AsString() == "RouteMatrix"s) {
+					outputstopjson.id = json_obj.at("id").AsInt();
+					outputstopjson.type = json_obj.at("type").AsString();
+					for (const auto& stop : json_obj.at("from").AsArray()) {
+						outputstopjson.origins.push_back(stop.AsString());
+					}
+					for (const auto& stop : json_obj.at("to").AsArray()) {
+						outputstopjson.destinations.push_back(stop.AsString());
+					}
+					if (json_obj.find("itineraries") != json_obj.end()) {
+						outputstopjson.itineraries = json_obj.at("itineraries").AsBool();
+					}
+					ReadRouteWeightOverrides(json_obj, outputstopjson);
+					out_req_.push_back(outputstopjson);
+				}
+				else if (json_obj.at("type").AsString() == "Isochrone"s) {
+					outputstopjson.id = json_obj.at("id").AsInt();
+					outputstopjson.type = json_obj.at("type").AsString();
+					outputstopjson.from = json_obj.at("from").AsString();
+					outputstopjson.max_time = json_obj.at("max_time").AsDouble();
+					ReadRouteWeightOverrides(json_obj, outputstopjson);
+					if (!(outputstopjson.max_time >= 0)) {
+						outputstopjson.error_message = "invalid max_time"s;
+					}
 					out_req_.push_back(outputstopjson);
 				}
 				else {
@@ -193,6 +248,91 @@ namespace transport_catalogue {
 		route_settings_.bus_velocity = json_obj.at("bus_velocity").AsDouble();
 		route_settings_.bus_wait_time = json_obj.at("bus_wait_time").AsDouble();
 
+		if (json_obj.find("router") != json_obj.end()) {
+			const std::string& router = json_obj.at("router").AsString();
+			if (router == "dijkstra"s) {
+				route_settings_.router_type = RouterType::DIJKSTRA;
+			}
+			else if (router == "precomputed"s) {
+				route_settings_.router_type = RouterType::PRECOMPUTED;
+			}
+			else if (router == "raptor"s) {
+				route_settings_.router_type = RouterType::RAPTOR;
+			}
+			else if (router == "ch"s) {
+				route_settings_.router_type = RouterType::CONTRACTION_HIERARCHIES;
+			}
+			else if (router == "astar"s) {
+				route_settings_.router_type = RouterType::ASTAR;
+			}
+			else if (router == "bidirectional"s) {
+				route_settings_.router_type = RouterType::BIDIRECTIONAL_DIJKSTRA;
+			}
+			else if (router == "alt"s) {
+				route_settings_.router_type = RouterType::ALT;
+			}
+			else {
+				throw std::invalid_argument("unknown router type: "s + router);
+			}
+		}
+
+		if (json_obj.find("router_threads") != json_obj.end()) {
+			const int threads = json_obj.at("router_threads").AsInt();
+			// 0 - по числу ядер процессора
+			if (threads < 0) {
+				throw std::invalid_argument("router_threads should be non-negative: "s + std::to_string(threads));
+			}
+			route_settings_.router_threads = threads;
+		}
+
+		if (json_obj.find("router_queue") != json_obj.end()) {
+			const std::string& queue = json_obj.at("router_queue").AsString();
+			if (queue == "binary_heap"s) {
+				route_settings_.router_queue = QueueType::BINARY_HEAP;
+			}
+			else if (queue == "radix_heap"s) {
+				route_settings_.router_queue = QueueType::RADIX_HEAP;
+			}
+			else {
+				throw std::invalid_argument("unknown router queue: "s + queue);
+			}
+		}
+
+		if (json_obj.find("router_cache_bytes") != json_obj.end()) {
+			const double cache_bytes = json_obj.at("router_cache_bytes").AsDouble();
+			// Отрицательное или бесконечное значение нельзя привести к size_t
+			if (!std::isfinite(cache_bytes) || cache_bytes < 0
+				|| cache_bytes >= static_cast<double>(std::numeric_limits<size_t>::max())) {
+				throw std::invalid_argument("router_cache_bytes should be a non-negative number of bytes");
+			}
+			route_settings_.router_cache_bytes = static_cast<size_t>(cache_bytes);
+		}
+
+		if (json_obj.find("router_landmarks") != json_obj.end()) {
+			const int landmarks = json_obj.at("router_landmarks").AsInt();
+			if (landmarks < 0) {
+				throw std::invalid_argument("router_landmarks should be non-negative: "s + std::to_string(landmarks));
+			}
+			route_settings_.router_landmarks = landmarks;
+		}
+
+		if (json_obj.find("router_float_weights") != json_obj.end()) {
+			route_settings_.router_float_weights = json_obj.at("router_float_weights").AsBool();
+		}
+
+		if (json_obj.find("graph_model") != json_obj.end()) {
+			const std::string& graph_model = json_obj.at("graph_model").AsString();
+			if (graph_model == "stop_pairs"s) {
+				route_settings_.graph_model = GraphModel::STOP_PAIRS;
+			}
+			else if (graph_model == "line_segments"s) {
+				route_settings_.graph_model = GraphModel::LINE_SEGMENTS;
+			}
+			else {
+				throw std::invalid_argument("unknown graph model: "s + graph_model);
+			}
+		}
+
 	}
 
 	void InputReaderJson::ReadInputJsonSerializeSettings() {
@@ -265,4 +405,45 @@ namespace transport_catalogue {
 		return serialize_file_path_;
 	}
 
+	std::optional<domain::RouteWeightParameters> InputReaderJson::GetWeightParameters(const OutputRequest& request,
+		const TransportCatalogue& tc) {
+		if (!request.bus_velocity && !request.bus_wait_time) {
+			return std::nullopt;
+		}
+		domain::RouteWeightParameters parameters = tc.GetRouteSettings().GetWeightParameters();
+		parameters.bus_velocity = request.bus_velocity.value_or(parameters.bus_velocity);
+		parameters.bus_wait_time = request.bus_wait_time.value_or(parameters.bus_wait_time);
+		return parameters;
+	}
+
+	json::Array InputReaderJson::RouteItemsToJson(const graph::DestinatioInfo& route) {
+		json::Array items;
+		for (const auto& el : route.route) {
+
+			if (std::holds_alternative<graph::BusActivity>(el)) {
+				const graph::BusActivity& act = std::get<graph::BusActivity>(el);
+
+				items.push_back(json::Builder{}
+					.StartDict()
+					.Key("bus").Value(act.bus_name)
+					.Key("span_count").Value(act.span_count)
+					.Key("time").Value(act.time)
+					.Key("type").Value("Bus")
+					.EndDict().Build());
+			}
+
+			else {
+				const graph::WaitingActivity& act = std::get<graph::WaitingActivity>(el);
+
+				items.push_back(json::Builder{}
+					.StartDict()
+					.Key("stop_name").Value(act.stop_name_from)
+					.Key("time").Value(act.time)
+					.Key("type").Value("Wait")
+					.EndDict().Build());
+			}
+		}
+		return items;
+	}
+
 }
\ No newline at end of file
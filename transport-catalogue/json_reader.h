@@ -3,6 +3,7 @@
 #include <sstream>
 #include <string>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <vector>
 
@@ -63,11 +64,23 @@ namespace transport_catalogue {
 		void UpdStopDist(TransportCatalogue& tc);
 
 
-		void ManageOutputRequests(TransportCatalogue& tc, MapRenderer& mr, graph::ActivityProcessor& actprocess)
+		// Отрисовка и маршрутизация запрашиваются через get_renderer и get_router только
+		// запросами, которым они нужны: их можно строить при первом обращении
+		void ManageOutputRequests(const TransportCatalogue& tc, const std::function<MapRenderer&()>& get_renderer,
+			const std::function<graph::ActivityProcessor&()>& get_router)
 		{
 			std::ostream& out = std::cout;
 			json::Array queries;
 			for (const auto& el : out_req_) {
+				if (el.error_message) {
+					queries.emplace_back(json::Builder{}
+						.StartDict()
+						.Key("request_id").Value(el.id)
+						.Key("error_message").Value(*el.error_message)
+						.EndDict().Build());
+					continue;
+				}
+
 				if (el.type == "Bus"s) {
 
 					const Bus* bus_resp = tc.FindBus(el.name);
@@ -118,9 +131,13 @@ namespace transport_catalogue {
 
 					}
 					else {
-						set<string> r = tc.GetStopInfo(el.name);
+						// Названия маршрутов копируются только в ответ
+						const domain::IdSpan bus_ids = tc.GetStopBuses(myStop->id);
 						json::Array routes;
-						std::copy(r.begin(), r.end(), std::back_inserter(routes));
+						routes.reserve(bus_ids.size());
+						for (uint32_t bus_id : bus_ids) {
+							routes.emplace_back(tc.GetBuses()[bus_id].bus_name);
+						}
 
 						json::Node answer_stop = json::Builder{}
 							.StartDict()
@@ -137,7 +154,7 @@ namespace transport_catalogue {
 				}
 				if (el.type == "Map"s) {
 
-					string map_str = mr.DrawRouteGetDoc(tc);
+					string map_str = get_renderer().DrawRouteGetDoc(tc);
 
 
 					json::Node answer_empty_map = json::Builder{}
@@ -155,7 +172,7 @@ namespace transport_catalogue {
 
 					if (tc.FindStop(el.from) && tc.FindStop(el.to)) {
 
-						std::optional<graph::DestinatioInfo> route = actprocess.GetRouteAndBuses(el.from, el.to);
+						std::optional<graph::DestinatioInfo> route = get_router().GetRouteAndBuses(el.from, el.to, GetWeightParameters(el, tc));
 						std::vector<json::Node> array;
 
 						int request_id = el.id;
@@ -164,39 +181,7 @@ namespace transport_catalogue {
 	
 						if (route.has_value()) {
 							total_time = route.value().all_time;
-							std::vector<std::variant<graph::BusActivity, graph::WaitingActivity>> final_route = route.value().route;
-
-							for (auto el : final_route) {
-
-								if (std::holds_alternative<graph::BusActivity>(el)) {
-									graph::BusActivity act = std::get<graph::BusActivity>(el);
-
-									json::Node bus_route_description = json::Builder{}
-										.StartDict()
-										.Key("bus").Value(act.bus_name)
-										.Key("span_count").Value(act.span_count)
-										.Key("time").Value(act.time)
-										.Key("type").Value("Bus")
-										.EndDict().Build();
-
-									array.push_back(bus_route_description);
-								}
-
-								else {
-									graph::WaitingActivity act = std::get<graph::WaitingActivity>(el);
-
-									json::Node bus_route_description = json::Builder{}
-										.StartDict()
-										.Key("stop_name").Value(act.stop_name_from)
-										.Key("time").Value(act.time)
-										.Key("type").Value("Wait")
-										.EndDict().Build();
-
-									array.push_back(bus_route_description);
-
-								}
-
-							}
+							array = RouteItemsToJson(route.value());
 							json::Node final_route_description = json::Builder{}
 								.StartDict()
 								.Key("items").Value(array)
@@ -232,6 +217,65 @@ namespace transport_catalogue {
 					}
 
 				}
+
+				else if (el.type == "RouteMatrix"s) {
+					const auto matrix = get_router().GetRouteMatrix(el.origins, el.destinations, el.itineraries,
+						GetWeightParameters(el, tc));
+
+					// Недостижимые пары и неизвестные остановки - null
+					json::Array total_times;
+					json::Array items;
+					for (const auto& row : matrix) {
+						json::Array times_row;
+						json::Array items_row;
+						for (const auto& route : row) {
+							times_row.emplace_back(route ? json::Node(route->all_time) : json::Node(nullptr));
+							if (el.itineraries) {
+								items_row.emplace_back(route ? json::Node(RouteItemsToJson(*route)) : json::Node(nullptr));
+							}
+						}
+						total_times.emplace_back(std::move(times_row));
+						if (el.itineraries) {
+							items.emplace_back(std::move(items_row));
+						}
+					}
+
+					json::Builder builder;
+					builder.StartDict()
+						.Key("request_id").Value(el.id)
+						.Key("total_times").Value(std::move(total_times));
+					if (el.itineraries) {
+						builder.Key("items").Value(std::move(items));
+					}
+					queries.emplace_back(builder.EndDict().Build());
+				}
+
+				else if (el.type == "Isochrone"s) {
+					const auto reachable = get_router().GetIsochrone(el.from, el.max_time, GetWeightParameters(el, tc));
+
+					if (reachable) {
+						json::Array items;
+						for (const auto& stop : *reachable) {
+							items.push_back(json::Builder{}
+								.StartDict()
+								.Key("stop_name").Value(std::string(stop.stop_name))
+								.Key("time").Value(stop.time)
+								.EndDict().Build());
+						}
+						queries.emplace_back(json::Builder{}
+							.StartDict()
+							.Key("items").Value(std::move(items))
+							.Key("request_id").Value(el.id)
+							.EndDict().Build());
+					}
+					else {
+						queries.emplace_back(json::Builder{}
+							.StartDict()
+							.Key("request_id").Value(el.id)
+							.Key("error_message").Value("not found"s)
+							.EndDict().Build());
+					}
+				}
 			}
 			json::Print(json::Document{ queries }, out);
 		}
@@ -246,6 +290,13 @@ namespace transport_catalogue {
 
 
 	private:
+		// Параметры весов из routing_settings запроса; nullopt, если запрос их не задаёт
+		static std::optional<domain::RouteWeightParameters> GetWeightParameters(const OutputRequest& request,
+			const TransportCatalogue& tc);
+
+		// Участки маршрута для ответов Route и RouteMatrix
+		static json::Array RouteItemsToJson(const graph::DestinatioInfo& route);
+
 		std::istream& is_;
 
 		std::deque<OutputRequest> out_req_;
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+    // Таблицы расстояний до опорных вершин (landmarks) для оценки A* по неравенству
+    // треугольника (ALT). Для опорной вершины l и цели t вес пути из v не меньше
+    // d(l, t) - d(l, v) и d(v, l) - d(t, l). Расстояния хранятся по вершинам:
+    // k значений каждой вершины лежат подряд, так что оценка читает две короткие строки
+    template <typename Weight>
+    struct LandmarkTables {
+        static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+            ? std::numeric_limits<Weight>::infinity()
+            : std::numeric_limits<Weight>::max();
+
+        std::vector<VertexId> landmarks;
+        std::vector<Weight> from_landmarks;  // [v * k + i] = d(landmarks[i], v)
+        std::vector<Weight> to_landmarks;    // [v * k + i] = d(v, landmarks[i])
+
+        // Выбирает до landmark_count опорных вершин среди candidates: каждая следующая -
+        // самая далёкая от уже выбранных - и считает расстояния до них и от них
+        static LandmarkTables Compute(const DirectedWeightedGraph<Weight>& graph,
+            const std::vector<VertexId>& candidates, size_t landmark_count);
+
+        // Согласованная нижняя оценка веса пути vertex -> target
+        Weight GetPotential(VertexId vertex, VertexId target) const;
+
+        // Сумма, в которой недостижимость поглощает второе слагаемое (без переполнения целых весов)
+        static Weight AddDistances(Weight lhs, Weight rhs) {
+            return lhs == UNREACHABLE_WEIGHT || rhs == UNREACHABLE_WEIGHT ? UNREACHABLE_WEIGHT : lhs + rhs;
+        }
+    };
+
+    namespace detail {
+
+        // Расстояния от source до всех вершин (backward - до source по входящим рёбрам)
+        template <typename Weight>
+        std::vector<Weight> ComputeDistances(const DirectedWeightedGraph<Weight>& graph, VertexId source, bool backward) {
+            using QueueItem = std::pair<Weight, VertexId>;
+            std::vector<Weight> distances(graph.GetVertexCount(), LandmarkTables<Weight>::UNREACHABLE_WEIGHT);
+            std::vector<QueueItem> queue{ { Weight{}, source } };
+            distances[source] = Weight{};
+
+            while (!queue.empty()) {
+                std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+                const auto [weight, vertex] = queue.back();
+                queue.pop_back();
+                if (distances[vertex] < weight) {
+                    continue;
+                }
+
+                const auto relax = [&](EdgeId edge_id, VertexId next) {
+                    const Weight candidate_weight = weight + graph.GetEdgeWeight(edge_id);
+                    if (candidate_weight < distances[next]) {
+                        distances[next] = candidate_weight;
+                        queue.push_back({ candidate_weight, next });
+                        std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+                    }
+                };
+                if (backward) {
+                    for (const EdgeId edge_id : graph.GetIncomingEdges(vertex)) {
+                        relax(edge_id, graph.GetEdgeSource(edge_id));
+                    }
+                }
+                else {
+                    for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                        relax(edge_id, graph.GetEdgeTarget(edge_id));
+                    }
+                }
+            }
+            return distances;
+        }
+
+    }  // namespace detail
+
+    template <typename Weight>
+    LandmarkTables<Weight> LandmarkTables<Weight>::Compute(const DirectedWeightedGraph<Weight>& graph,
+        const std::vector<VertexId>& candidates, size_t landmark_count) {
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+
+        const size_t vertex_count = graph.GetVertexCount();
+        landmark_count = std::min(landmark_count, candidates.size());
+
+        std::vector<std::vector<Weight>> from_rows;
+        std::vector<std::vector<Weight>> to_rows;
+        LandmarkTables tables;
+
+        // Удалённость кандидата от выбранных: наименьшая по ним сумма расстояний туда и обратно.
+        // Первая опорная вершина - самая далёкая от первого кандидата
+        std::vector<Weight> separation(vertex_count, UNREACHABLE_WEIGHT);
+        if (landmark_count > 0) {
+            const auto from_first = detail::ComputeDistances(graph, candidates.front(), false);
+            const auto to_first = detail::ComputeDistances(graph, candidates.front(), true);
+            for (const VertexId vertex : candidates) {
+                separation[vertex] = AddDistances(from_first[vertex], to_first[vertex]);
+            }
+        }
+
+        while (tables.landmarks.size() < landmark_count) {
+            // Недостижимые кандидаты (другая компонента) выбираются в первую очередь
+            VertexId landmark = candidates.front();
+            for (const VertexId vertex : candidates) {
+                if (separation[landmark] < separation[vertex]) {
+                    landmark = vertex;
+                }
+            }
+            if (separation[landmark] == Weight{}) {
+                break;
+            }
+
+            tables.landmarks.push_back(landmark);
+            from_rows.push_back(detail::ComputeDistances(graph, landmark, false));
+            to_rows.push_back(detail::ComputeDistances(graph, landmark, true));
+            for (const VertexId vertex : candidates) {
+                separation[vertex] = std::min(separation[vertex], AddDistances(from_rows.back()[vertex], to_rows.back()[vertex]));
+            }
+        }
+
+        const size_t count = tables.landmarks.size();
+        tables.from_landmarks.resize(vertex_count * count);
+        tables.to_landmarks.resize(vertex_count * count);
+        for (size_t i = 0; i < count; ++i) {
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                tables.from_landmarks[vertex * count + i] = from_rows[i][vertex];
+                tables.to_landmarks[vertex * count + i] = to_rows[i][vertex];
+            }
+        }
+        return tables;
+    }
+
+    template <typename Weight>
+    Weight LandmarkTables<Weight>::GetPotential(VertexId vertex, VertexId target) const {
+        const size_t count = landmarks.size();
+        const Weight* from_vertex = from_landmarks.data() + vertex * count;
+        const Weight* from_target = from_landmarks.data() + target * count;
+        const Weight* to_vertex = to_landmarks.data() + vertex * count;
+        const Weight* to_target = to_landmarks.data() + target * count;
+
+        // Слагаемые с недостижимыми расстояниями пропускаются: оценка слабее, но допустима.
+        // Разность берётся только положительная, чтобы не переполнять беззнаковые веса
+        Weight potential{};
+        for (size_t i = 0; i < count; ++i) {
+            if (from_target[i] != UNREACHABLE_WEIGHT && from_vertex[i] < from_target[i]) {
+                potential = std::max(potential, static_cast<Weight>(from_target[i] - from_vertex[i]));
+            }
+            if (to_vertex[i] != UNREACHABLE_WEIGHT && to_target[i] < to_vertex[i]) {
+                potential = std::max(potential, static_cast<Weight>(to_vertex[i] - to_target[i]));
+            }
+        }
+        return potential;
+    }
+
+}  // namespace graph
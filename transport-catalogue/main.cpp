@@ -11,6 +11,7 @@ using namespace std;
 #include <chrono>
 #include "serialization.h"
 #include "transport_router.h"
+#include <optional>
 #include <string_view>
 
 using namespace std::literals;
@@ -41,6 +42,8 @@ int main(int argc, char* argv[]) {
         reader.UpdStop(tc);
         reader.UpdBus(tc);
         reader.UpdStopDist(tc);
+        tc.IndexRoutes();
+        tc.ComputeBusStats();
         reader.UpdRouteSettings(tc);
         reader.UpdSerializeSettings(tc);
 
@@ -50,7 +53,10 @@ int main(int argc, char* argv[]) {
 
         domain::RouteSettings routeSettings = tc.GetRouteSettings();
 
-        serialization::catalogue_serialization(tc, rd , routeSettings, out_file);
+        // Граф и таблица маршрутов считаются один раз при создании базы
+        graph::ActivityProcessor activityprocessor(tc);
+
+        serialization::catalogue_serialization(tc, rd , routeSettings, activityprocessor, out_file);
 
        
     }
@@ -68,12 +74,29 @@ int main(int argc, char* argv[]) {
         ifstream in_file(reader.GetSerializeFilePath(), ios::binary);
         auto catalogue = serialization::catalogue_deserialization(in_file);
         RenderSettings rd = catalogue.render_settings_;
-        transport_catalogue::TransportCatalogue tc = catalogue.transport_catalogue_;
-        tc.AddRouteSettings(catalogue.routing_settings_);
+        // Обработчики читают справочник через снимок из хранилища: замена снимка не трогает уже выданный
+        const transport_catalogue::FrozenCatalogueHolder catalogue_holder(catalogue.transport_catalogue_);
+        const std::shared_ptr<const transport_catalogue::TransportCatalogue> snapshot = catalogue_holder.Load();
+        const transport_catalogue::TransportCatalogue& tc = *snapshot;
 
-        MapRenderer mapdrawer(rd);
-        graph::ActivityProcessor activityprocessor(tc);
-        reader.ManageOutputRequests(tc, mapdrawer, activityprocessor);
+        // Отрисовка и маршрутизация строятся при первом запросе, которому они нужны:
+        // пакет из одних запросов Bus и Stop не разбирает граф и таблицы маршрутизатора
+        std::optional<MapRenderer> mapdrawer;
+        std::optional<graph::ActivityProcessor> activityprocessor;
+        reader.ManageOutputRequests(tc,
+            [&]() -> MapRenderer& {
+                if (!mapdrawer) {
+                    mapdrawer.emplace(rd);
+                }
+                return *mapdrawer;
+            },
+            [&]() -> graph::ActivityProcessor& {
+                if (!activityprocessor) {
+                    activityprocessor.emplace(tc, serialization::routing_data_deserialization(catalogue));
+                    catalogue.serialized_router_ = std::string{};
+                }
+                return *activityprocessor;
+            });
     }
     else {
         PrintUsage();
@@ -16,7 +16,7 @@ namespace transport_catalogue {
         std::string font = "Verdana"; // Название шрифта
         std::string font_weight = "bold"; // Толщина шрифта
         std::string text_data; // Текстовое содержимое объекта
-        std::string_view last_stop; // Текстовое содержимое объекта
+        uint32_t last_stop; // индекс последней остановки в GetStops()
         Color route_color;
     };
 
@@ -50,35 +50,29 @@ namespace transport_catalogue {
 
     }
 
-    deque<string_view> GetStopsForNonRounTtip(deque<string_view> stops) {
-        deque<string_view> reverse_stops;
-        reverse_stops.insert(reverse_stops.end(), stops.begin(), stops.end());
-        std::reverse(stops.begin(), stops.end());
-        stops.pop_front();
+    vector<uint32_t> GetStopsForNonRounTtip(const vector<uint32_t>& stops) {
+        vector<uint32_t> reverse_stops;
+        reverse_stops.reserve(stops.size() * 2);
         reverse_stops.insert(reverse_stops.end(), stops.begin(), stops.end());
+        reverse_stops.insert(reverse_stops.end(), std::next(stops.rbegin()), stops.rend());
 
         return reverse_stops;
 
     }
 
     vector<geo::Coordinates> GetAllCoordinates(const TransportCatalogue& rtotc, const std::deque<Bus>& buses) {
+        const std::deque<Stop>& stops = rtotc.GetStops();
         vector<geo::Coordinates> geo_coords;
         for (const auto& bus : buses) {
-            std::deque<std::string_view> current_stops;
-            if (bus.type != "true") {
-                current_stops = GetStopsForNonRounTtip(bus.stops);
-            }
-            else { current_stops = bus.stops; }
-            for (int i = 0; i < static_cast<int>(current_stops.size()); i++) {
-                const Stop* one = rtotc.FindStop(current_stops[i]);
-                geo_coords.push_back(one->coordinates);
+            for (uint32_t stop_id : bus.stops) {
+                geo_coords.push_back(stops[stop_id].coordinates);
             }
         }
         return geo_coords;
     }
 
 
-    bool  CheckSameStations(const deque<string_view>& current_stops) {
+    bool  CheckSameStations(const vector<uint32_t>& current_stops) {
         if (current_stops.front() == current_stops.back()) {
             return true;
         }
@@ -103,7 +97,7 @@ namespace transport_catalogue {
         vector<svg::Text> routes_text;
         std::vector<Color> color_palette = render_settings_.color_palette_;
         std::deque<Bus> buses = tc.GetBuses();
-        std::deque<Stop> stops = tc.GetStops();
+        const std::deque<Stop>& stops = tc.GetStops();
         std::sort(buses.begin(), buses.end(),
             [](const Bus& a, const Bus& b) { return a.bus_name < b.bus_name; });
 
@@ -114,13 +108,21 @@ namespace transport_catalogue {
         geo_coords.begin(), geo_coords.end(), render_settings_.width_, render_settings_.height_, render_settings_.padding_
         };
 
-        std::set<std::string> stops_for_route;
-
+        // Остановки, через которые проходит хотя бы один автобус, по алфавиту
+        std::vector<bool> is_route_stop(stops.size(), false);
+        for (const auto& bus : buses) {
+            for (uint32_t stop_id : bus.stops) {
+                is_route_stop[stop_id] = true;
+            }
+        }
+        std::vector<const Stop*> stops_for_route;
         for (const auto& el : stops) {
-            if (tc.GetStopInfo(el.stop_name).size() != 0) {
-                stops_for_route.insert(el.stop_name);
+            if (is_route_stop[el.id]) {
+                stops_for_route.push_back(&el);
             }
         }
+        std::sort(stops_for_route.begin(), stops_for_route.end(),
+            [](const Stop* a, const Stop* b) { return a->stop_name < b->stop_name; });
 
         for (const auto& bus : buses) {
             if (bus.stops.size() == 0) {
@@ -135,7 +137,7 @@ namespace transport_catalogue {
 
 
             Color current_color;
-            deque<string_view> current_stops;
+            vector<uint32_t> current_stops;
             if (colors.count(bus.bus_name)) {
                 {
                     current_color = colors[bus.bus_name];
@@ -159,7 +161,7 @@ namespace transport_catalogue {
 
 
             for (int i = 0; i < static_cast<int>(current_stops.size()); i++) {
-                const Stop* one = tc.FindStop(current_stops[i]);
+                const Stop* one = &stops[current_stops[i]];
                 const svg::Point screen_coord = proj_one(one->coordinates);
                 svg::Point p;
                 p.x = screen_coord.x;
@@ -184,7 +186,7 @@ namespace transport_catalogue {
             }
 
             if (!same_stations) {
-                const Stop* last = tc.FindStop(rout_description.last_stop);
+                const Stop* last = &stops[rout_description.last_stop];
                 const svg::Point screen_coord_last = proj_one(last->coordinates);
                 Text route_font_not_same;
                 Text route_not_same;
@@ -214,7 +216,7 @@ namespace transport_catalogue {
         for (auto i = stops_for_route.begin(); i != stops_for_route.end(); ++i)
         {
             Circle c;
-            const Stop* one = tc.FindStop(*i);
+            const Stop* one = *i;
             const svg::Point screen_coord = proj_one(one->coordinates);
             c.SetRadius(render_settings_.stop_radius_).SetCenter({ screen_coord.x, screen_coord.y });
             c.SetFillColor("white");
@@ -224,12 +226,12 @@ namespace transport_catalogue {
             Text stop_description;
 
             stop_description_font.SetPosition(Point(screen_coord.x, screen_coord.y)).SetOffset(Point(render_settings_.stop_label_offset_.first, render_settings_.stop_label_offset_.second)).SetFontSize(render_settings_.stop_label_font_size_)\
-                .SetFontFamily("Verdana").SetData(*i)\
+                .SetFontFamily("Verdana").SetData(one->stop_name)\
                 .SetFillColor(render_settings_.underlayer_color_).SetStrokeColor(render_settings_.underlayer_color_).SetStrokeWidth(render_settings_.underlayer_width_).SetStrokeLineCap(StrokeLineCap::ROUND).SetStrokeLineJoin(StrokeLineJoin::ROUND);
 
 
             stop_description.SetPosition(Point(screen_coord.x, screen_coord.y)).SetOffset(Point(render_settings_.stop_label_offset_.first, render_settings_.stop_label_offset_.second)).SetFontSize(render_settings_.stop_label_font_size_)\
-                .SetFontFamily("Verdana").SetData(*i).SetFillColor("black");
+                .SetFontFamily("Verdana").SetData(one->stop_name).SetFillColor("black");
 
             stops_names.push_back(stop_description_font);
             stops_names.push_back(stop_description);
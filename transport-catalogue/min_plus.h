@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TC_MIN_PLUS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+    namespace detail {
+
+        // Ядро min-plus для строки таблицы путей: для i из [0, count)
+        // если through_weight + weights_through[i] < weights_from[i], то
+        // weights_from[i] = through_weight + weights_through[i], prev_from[i] = prev_through[i].
+        // Недостижимость - бесконечность, поэтому сумма с ней никогда не побеждает и ветвлений нет
+        template <typename Weight>
+        using MinPlusRowKernel = void (*)(Weight* weights_from, uint32_t* prev_from,
+            const Weight* weights_through, const uint32_t* prev_through, Weight through_weight, size_t count);
+
+        template <typename Weight>
+        void MinPlusRowScalar(Weight* weights_from, uint32_t* prev_from,
+            const Weight* weights_through, const uint32_t* prev_through, Weight through_weight, size_t count) {
+            static_assert(std::is_floating_point_v<Weight>, "Min-plus kernel relies on infinity for unreachable routes");
+            for (size_t i = 0; i < count; ++i) {
+                const Weight candidate_weight = through_weight + weights_through[i];
+                const bool better = candidate_weight < weights_from[i];
+                weights_from[i] = better ? candidate_weight : weights_from[i];
+                prev_from[i] = better ? prev_through[i] : prev_from[i];
+            }
+        }
+
+#ifdef TC_MIN_PLUS_AVX2
+        __attribute__((target("avx2")))
+        inline void MinPlusRowAvx2(double* weights_from, uint32_t* prev_from,
+            const double* weights_through, const uint32_t* prev_through, double through_weight, size_t count) {
+            const __m256d through = _mm256_set1_pd(through_weight);
+            // Маска из четырёх 64-битных полос сжимается в четыре 32-битные для номеров рёбер
+            const __m256i pack_lanes = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m256d current = _mm256_loadu_pd(weights_from + i);
+                const __m256d candidate = _mm256_add_pd(through, _mm256_loadu_pd(weights_through + i));
+                const __m256d better = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+                _mm256_storeu_pd(weights_from + i, _mm256_blendv_pd(current, candidate, better));
+
+                const __m128 better_lanes = _mm_castsi128_ps(_mm256_castsi256_si128(
+                    _mm256_permutevar8x32_epi32(_mm256_castpd_si256(better), pack_lanes)));
+                const __m128 prev = _mm_loadu_ps(reinterpret_cast<const float*>(prev_from + i));
+                const __m128 prev_candidate = _mm_loadu_ps(reinterpret_cast<const float*>(prev_through + i));
+                _mm_storeu_ps(reinterpret_cast<float*>(prev_from + i), _mm_blendv_ps(prev, prev_candidate, better_lanes));
+            }
+            MinPlusRowScalar(weights_from + i, prev_from + i, weights_through + i, prev_through + i, through_weight, count - i);
+        }
+
+        __attribute__((target("avx2")))
+        inline void MinPlusRowAvx2(float* weights_from, uint32_t* prev_from,
+            const float* weights_through, const uint32_t* prev_through, float through_weight, size_t count) {
+            const __m256 through = _mm256_set1_ps(through_weight);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256 current = _mm256_loadu_ps(weights_from + i);
+                const __m256 candidate = _mm256_add_ps(through, _mm256_loadu_ps(weights_through + i));
+                const __m256 better = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+                _mm256_storeu_ps(weights_from + i, _mm256_blendv_ps(current, candidate, better));
+
+                const __m256 prev = _mm256_loadu_ps(reinterpret_cast<const float*>(prev_from + i));
+                const __m256 prev_candidate = _mm256_loadu_ps(reinterpret_cast<const float*>(prev_through + i));
+                _mm256_storeu_ps(reinterpret_cast<float*>(prev_from + i), _mm256_blendv_ps(prev, prev_candidate, better));
+            }
+            MinPlusRowScalar(weights_from + i, prev_from + i, weights_through + i, prev_through + i, through_weight, count - i);
+        }
+#endif
+
+        // Выбор ядра по возможностям процессора, на котором запущена программа
+        template <typename Weight>
+        MinPlusRowKernel<Weight> SelectMinPlusRowKernel() {
+#ifdef TC_MIN_PLUS_AVX2
+            if constexpr (std::is_same_v<Weight, double> || std::is_same_v<Weight, float>) {
+                if (__builtin_cpu_supports("avx2")) {
+                    return static_cast<MinPlusRowKernel<Weight>>(&MinPlusRowAvx2);
+                }
+            }
+#endif
+            return &MinPlusRowScalar<Weight>;
+        }
+
+    }  // namespace detail
+
+}  // namespace graph
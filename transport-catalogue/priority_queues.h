@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace graph {
+
+    // Очереди с приоритетом для поиска кратчайших путей. Элемент очереди хранит ключ
+    // в поле key, извлекается элемент с наименьшим ключом.
+    // Интерфейс: Push(item), Pop() -> item, IsEmpty(), Clear()
+
+    // Двоичная куча на векторе
+    template <typename Item>
+    class BinaryHeap {
+    public:
+        void Push(const Item& item) {
+            items_.push_back(item);
+            std::push_heap(items_.begin(), items_.end(), Greater{});
+        }
+
+        Item Pop() {
+            std::pop_heap(items_.begin(), items_.end(), Greater{});
+            const Item item = items_.back();
+            items_.pop_back();
+            return item;
+        }
+
+        bool IsEmpty() const {
+            return items_.empty();
+        }
+
+        void Clear() {
+            items_.clear();
+        }
+
+    private:
+        struct Greater {
+            bool operator()(const Item& lhs, const Item& rhs) const {
+                return lhs.key > rhs.key;
+            }
+        };
+
+        std::vector<Item> items_;
+    };
+
+    namespace detail {
+
+        // Отображение неотрицательного ключа в целое с сохранением порядка: у неотрицательных
+        // чисел IEEE 754 порядок битовых представлений совпадает с порядком значений
+        template <typename Key>
+        uint64_t ToRadixKey(Key key) {
+            if constexpr (std::is_same_v<Key, double>) {
+                uint64_t bits;
+                std::memcpy(&bits, &key, sizeof(bits));
+                return bits;
+            }
+            else if constexpr (std::is_same_v<Key, float>) {
+                uint32_t bits;
+                std::memcpy(&bits, &key, sizeof(bits));
+                return bits;
+            }
+            else {
+                static_assert(std::is_integral_v<Key>, "Radix heap needs an integral or floating point key");
+                return static_cast<uint64_t>(key);
+            }
+        }
+
+    }  // namespace detail
+
+    // Монотонная поразрядная куча (radix heap): элемент лежит в корзине по номеру старшего
+    // бита, которым его ключ отличается от последнего извлечённого. Push - O(1), извлечение
+    // перекладывает элементы только в младшие корзины, поэтому каждый элемент
+    // перекладывается не больше 64 раз за всё время жизни.
+    // Ключи должны быть неотрицательными, а добавляемый ключ - не меньше последнего
+    // извлечённого (так ведут себя Дейкстра и A* с согласованной оценкой). Меньший ключ
+    // считается равным последнему извлечённому
+    template <typename Item>
+    class RadixHeap {
+    public:
+        void Push(const Item& item) {
+            const uint64_t key = std::max(detail::ToRadixKey(item.key), last_key_);
+            buckets_[GetBucket(key)].push_back({ key, item });
+            ++size_;
+        }
+
+        Item Pop() {
+            if (buckets_[0].empty()) {
+                size_t index = 1;
+                while (buckets_[index].empty()) {
+                    ++index;
+                }
+
+                auto& bucket = buckets_[index];
+                last_key_ = std::min_element(bucket.begin(), bucket.end(),
+                    [](const Entry& lhs, const Entry& rhs) { return lhs.key < rhs.key; })->key;
+                for (const Entry& entry : bucket) {
+                    buckets_[GetBucket(entry.key)].push_back(entry);
+                }
+                bucket.clear();
+            }
+
+            const Item item = buckets_[0].back().item;
+            buckets_[0].pop_back();
+            --size_;
+            return item;
+        }
+
+        bool IsEmpty() const {
+            return size_ == 0;
+        }
+
+        void Clear() {
+            for (auto& bucket : buckets_) {
+                bucket.clear();
+            }
+            size_ = 0;
+            last_key_ = 0;
+        }
+
+    private:
+        struct Entry {
+            uint64_t key;
+            Item item;
+        };
+
+        size_t GetBucket(uint64_t key) const {
+            const uint64_t diff = key ^ last_key_;
+#if defined(__GNUC__)
+            return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+#else
+            size_t bucket = 0;
+            for (uint64_t rest = diff; rest != 0; rest >>= 1) {
+                ++bucket;
+            }
+            return bucket;
+#endif
+        }
+
+        std::array<std::vector<Entry>, 65> buckets_;
+        size_t size_ = 0;
+        uint64_t last_key_ = 0;
+    };
+
+}  // namespace graph
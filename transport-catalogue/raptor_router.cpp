@@ -0,0 +1,219 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+
+namespace graph {
+
+	namespace {
+		constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+	}
+
+	RaptorRouter::RaptorRouter(const transport_catalogue::TransportCatalogue& tc) {
+		const std::deque<domain::Stop>& stops = tc.GetStops();
+
+		for (const domain::Stop& stop : stops) {
+			stop_ids_.emplace(stop.stop_name, stop.id);
+		}
+
+		for (const domain::Bus& bus : tc.GetBuses()) {
+			AddLine(bus.stops, bus.distances, bus.id);
+			if (bus.type != "true") {
+				const std::vector<uint32_t> reversed_stops(bus.stops.rbegin(), bus.stops.rend());
+				AddLine(reversed_stops, bus.return_distances, bus.id);
+			}
+		}
+
+		stop_lines_offsets_.assign(stops.size() + 1, 0);
+		for (const uint32_t stop : line_stops_) {
+			++stop_lines_offsets_[stop + 1];
+		}
+		for (size_t stop = 0; stop < stops.size(); ++stop) {
+			stop_lines_offsets_[stop + 1] += stop_lines_offsets_[stop];
+		}
+
+		std::vector<uint32_t> positions(stop_lines_offsets_.begin(), stop_lines_offsets_.end() - 1);
+		stop_lines_.resize(line_stops_.size());
+		for (uint32_t line = 0; line < lines_.size(); ++line) {
+			for (uint32_t position = 0; position < lines_[line].stop_count; ++position) {
+				const uint32_t stop = line_stops_[lines_[line].first_position + position];
+				stop_lines_[positions[stop]++] = { line, position };
+			}
+		}
+
+		best_labels_.assign(stops.size(), UNREACHABLE);
+		is_marked_.assign(stops.size(), false);
+		line_board_positions_.assign(lines_.size(), NO_POSITION);
+	}
+
+	void RaptorRouter::AddLine(const std::vector<uint32_t>& stops, const std::vector<int>& distances, uint32_t bus_id) {
+		if (stops.empty()) {
+			return;
+		}
+
+		lines_.push_back({ bus_id, static_cast<uint32_t>(line_stops_.size()), static_cast<uint32_t>(stops.size()) });
+		for (size_t i = 0; i < stops.size(); ++i) {
+			line_stops_.push_back(stops[i]);
+			if (i + 1 < stops.size()) {
+				segment_distances_.push_back(distances[i]);
+			}
+			else {
+				segment_distances_.push_back(0);
+			}
+		}
+	}
+
+	void RaptorRouter::PrepareRound(size_t round) const {
+		const size_t stop_count = best_labels_.size();
+		if (round_labels_.size() <= round) {
+			round_labels_.emplace_back(stop_count, UNREACHABLE);
+			round_parents_.emplace_back(stop_count);
+		}
+
+		if (round == 0) {
+			std::fill(round_labels_[0].begin(), round_labels_[0].end(), UNREACHABLE);
+			std::fill(round_parents_[0].begin(), round_parents_[0].end(), Parent{});
+		}
+		else {
+			// Метки раунда начинаются с меток предыдущего: не более k посадок включает и меньше
+			round_labels_[round] = round_labels_[round - 1];
+			round_parents_[round] = round_parents_[round - 1];
+		}
+	}
+
+	std::optional<std::vector<RaptorLeg>> RaptorRouter::BuildRoute(std::string_view stop_name_from, std::string_view stop_name_to,
+		const domain::RouteWeightParameters& parameters) const {
+		const auto from_it = stop_ids_.find(stop_name_from);
+		const auto to_it = stop_ids_.find(stop_name_to);
+		if (from_it == stop_ids_.end() || to_it == stop_ids_.end()) {
+			return std::nullopt;
+		}
+		const uint32_t from = from_it->second;
+		const uint32_t to = to_it->second;
+
+		// Как и в графе, остановки без автобусов в маршрутах не участвуют
+		if (stop_lines_offsets_[from] == stop_lines_offsets_[from + 1]
+			|| stop_lines_offsets_[to] == stop_lines_offsets_[to + 1]) {
+			return std::nullopt;
+		}
+
+		const size_t round = RunRounds(from, to, UNREACHABLE, parameters);
+
+		if (best_labels_[to] == UNREACHABLE) {
+			return std::nullopt;
+		}
+
+		// Восстановление пути: от метки к остановке посадки в раунде, предшествующем её установке
+		std::vector<RaptorLeg> legs;
+		uint32_t stop = to;
+		for (size_t label_round = round; stop != from;) {
+			const Parent& parent = round_parents_[label_round][stop];
+			const Line& line = lines_[parent.line];
+			const uint32_t board_stop = line_stops_[line.first_position + parent.board_position];
+			legs.push_back({ board_stop, line.bus_id,
+				static_cast<int>(parent.alight_position - parent.board_position), parent.ride_time });
+			stop = board_stop;
+			label_round = parent.round - 1;
+		}
+		std::reverse(legs.begin(), legs.end());
+
+		return legs;
+	}
+
+	std::optional<std::vector<std::pair<uint32_t, double>>> RaptorRouter::BuildReachable(std::string_view stop_name_from,
+		double max_time, const domain::RouteWeightParameters& parameters) const {
+		const auto from_it = stop_ids_.find(stop_name_from);
+		if (from_it == stop_ids_.end()) {
+			return std::nullopt;
+		}
+		const uint32_t from = from_it->second;
+		if (stop_lines_offsets_[from] == stop_lines_offsets_[from + 1]) {
+			return std::nullopt;
+		}
+
+		RunRounds(from, std::nullopt, max_time, parameters);
+
+		std::vector<std::pair<uint32_t, double>> reachable;
+		for (uint32_t stop = 0; stop < best_labels_.size(); ++stop) {
+			if (best_labels_[stop] != UNREACHABLE) {
+				reachable.emplace_back(stop, best_labels_[stop]);
+			}
+		}
+		return reachable;
+	}
+
+	size_t RaptorRouter::RunRounds(uint32_t from, std::optional<uint32_t> to, double max_time,
+		const domain::RouteWeightParameters& parameters) const {
+		const double meters_per_minute = parameters.bus_velocity * 1000 / 60;
+		const double wait_time = parameters.bus_wait_time;
+
+		std::fill(best_labels_.begin(), best_labels_.end(), UNREACHABLE);
+		PrepareRound(0);
+		round_labels_[0][from] = 0;
+		best_labels_[from] = 0;
+		marked_stops_.assign(1, from);
+
+		size_t round = 0;
+		while (!marked_stops_.empty()) {
+			++round;
+			PrepareRound(round);
+
+			// Направления, проходящие через отмеченные остановки, с самой ранней позицией посадки
+			for (const uint32_t stop : marked_stops_) {
+				is_marked_[stop] = false;
+				for (uint32_t i = stop_lines_offsets_[stop]; i < stop_lines_offsets_[stop + 1]; ++i) {
+					const auto [line, position] = stop_lines_[i];
+					if (line_board_positions_[line] == NO_POSITION) {
+						queued_lines_.push_back(line);
+						line_board_positions_[line] = position;
+					}
+					else {
+						line_board_positions_[line] = std::min(line_board_positions_[line], position);
+					}
+				}
+			}
+			marked_stops_.clear();
+
+			const std::vector<double>& previous_labels = round_labels_[round - 1];
+			std::vector<double>& labels = round_labels_[round];
+			std::vector<Parent>& parents = round_parents_[round];
+
+			for (const uint32_t line_index : queued_lines_) {
+				const Line& line = lines_[line_index];
+				bool boarded = false;
+				double board_label = 0;
+				uint32_t board_position = 0;
+				double ride_time = 0;
+
+				for (uint32_t position = line_board_positions_[line_index]; position < line.stop_count; ++position) {
+					const uint32_t stop = line_stops_[line.first_position + position];
+
+					if (boarded) {
+						ride_time += segment_distances_[line.first_position + position - 1] / meters_per_minute;
+						const double arrival = board_label + ride_time;
+						if (arrival < best_labels_[stop] && arrival <= max_time && (!to || arrival < best_labels_[*to])) {
+							labels[stop] = arrival;
+							best_labels_[stop] = arrival;
+							parents[stop] = { line_index, board_position, position, static_cast<uint32_t>(round), ride_time };
+							if (!is_marked_[stop]) {
+								is_marked_[stop] = true;
+								marked_stops_.push_back(stop);
+							}
+						}
+					}
+
+					if (previous_labels[stop] != UNREACHABLE
+						&& (!boarded || previous_labels[stop] + wait_time < board_label + ride_time)) {
+						boarded = true;
+						board_label = previous_labels[stop] + wait_time;
+						board_position = position;
+						ride_time = 0;
+					}
+				}
+				line_board_positions_[line_index] = NO_POSITION;
+			}
+			queued_lines_.clear();
+		}
+		return round;
+	}
+
+}  // namespace graph
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Участок поездки: посадка на остановке board_stop и поездка на span_count остановок
+    struct RaptorLeg {
+        uint32_t board_stop;  // индекс остановки в GetStops()
+        uint32_t bus_id;      // индекс автобуса в GetBuses()
+        int span_count;
+        double ride_time;
+    };
+
+    // Поиск маршрута по раундам (RAPTOR) прямо по последовательностям остановок автобусов,
+    // без построения графа. Хранятся расстояния между остановками, а время считается
+    // в запросе по переданным скорости и времени ожидания. Раунд k находит лучшее время прибытия на остановки не более
+    // чем за k посадок: каждое направление маршрута просматривается одним проходом по
+    // массиву его остановок. Расписаний нет, поэтому каждая посадка стоит bus_wait_time,
+    // а раунды продолжаются, пока время прибытия хоть где-то улучшается
+    class RaptorRouter {
+    public:
+        explicit RaptorRouter(const transport_catalogue::TransportCatalogue& tc);
+
+        std::optional<std::vector<RaptorLeg>> BuildRoute(std::string_view stop_name_from, std::string_view stop_name_to,
+            const domain::RouteWeightParameters& parameters) const;
+
+        // Остановки (индексы в GetStops()), до которых можно доехать не дольше max_time минут,
+        // и время прибытия на них. nullopt - остановки нет или через неё не ходят автобусы
+        std::optional<std::vector<std::pair<uint32_t, double>>> BuildReachable(std::string_view stop_name_from, double max_time,
+            const domain::RouteWeightParameters& parameters) const;
+
+    private:
+        static constexpr double UNREACHABLE = std::numeric_limits<double>::infinity();
+
+        // Направление маршрута: остановки лежат в line_stops_ с позиции first_position
+        struct Line {
+            uint32_t bus_id;
+            uint32_t first_position;
+            uint32_t stop_count;
+        };
+
+        struct Parent {
+            uint32_t line;
+            uint32_t board_position;
+            uint32_t alight_position;
+            uint32_t round;  // раунд, в котором установлена метка
+            double ride_time;
+        };
+
+        void AddLine(const std::vector<uint32_t>& stops, const std::vector<int>& distances, uint32_t bus_id);
+        void PrepareRound(size_t round) const;
+        // Раунды от from, пока метки улучшаются. Метки позже max_time и не лучше
+        // уже найденной для to отбрасываются. Возвращает номер последнего раунда
+        size_t RunRounds(uint32_t from, std::optional<uint32_t> to, double max_time,
+            const domain::RouteWeightParameters& parameters) const;
+
+        std::unordered_map<std::string_view, uint32_t> stop_ids_;
+
+        std::vector<Line> lines_;
+        std::vector<uint32_t> line_stops_;
+        std::vector<int> segment_distances_;  // метры от позиции до следующей, выровнено с line_stops_
+
+        // Для каждой остановки - пары (направление, позиция) в формате CSR
+        std::vector<uint32_t> stop_lines_offsets_;
+        std::vector<std::pair<uint32_t, uint32_t>> stop_lines_;
+
+        // Буферы поиска, общие для всех запросов
+        mutable std::vector<std::vector<double>> round_labels_;
+        mutable std::vector<std::vector<Parent>> round_parents_;
+        mutable std::vector<double> best_labels_;
+        mutable std::vector<uint32_t> marked_stops_;
+        mutable std::vector<bool> is_marked_;
+        mutable std::vector<uint32_t> line_board_positions_;
+        mutable std::vector<uint32_t> queued_lines_;
+    };
+
+}  // namespace graph
@@ -4,7 +4,7 @@
 
 namespace transport_catalogue {
 
-    RequestHandler::RequestHandler(TransportCatalogue& tc, MapRenderer& renderer) : tc_(tc), renderer_(renderer) {}
+    RequestHandler::RequestHandler(const TransportCatalogue& tc, MapRenderer& renderer) : tc_(tc), renderer_(renderer) {}
 
     void RequestHandler::RenderMapByString() {
         std::string str = renderer_.DrawRouteGetDoc(tc_);
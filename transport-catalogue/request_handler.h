@@ -9,13 +9,13 @@ namespace transport_catalogue {
     class RequestHandler {
     public:
         
-        RequestHandler(transport_catalogue::TransportCatalogue& tc, MapRenderer& renderer);
+        RequestHandler(const transport_catalogue::TransportCatalogue& tc, MapRenderer& renderer);
                 
         void RenderMapByString();
 
     private:
         // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
-        transport_catalogue::TransportCatalogue& tc_;
+        const transport_catalogue::TransportCatalogue& tc_;
         MapRenderer& renderer_;
     };
 }
\ No newline at end of file
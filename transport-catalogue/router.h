@@ -1,118 +1,265 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
-    template <typename Weight>
-    class Router {
-    private:
-        using Graph = DirectedWeightedGraph<Weight>;
+    namespace detail {
 
-    public:
+        // Выполняет func(index) для index из [0, count) на thread_count потоках.
+        // Потоки разбирают индексы через общий счётчик, вызывающий поток тоже работает
+        template <typename Func>
+        void ParallelFor(size_t count, size_t thread_count, const Func& func) {
+            std::atomic<size_t> next_index{ 0 };
+            auto worker = [&]() {
+                for (size_t index = next_index++; index < count; index = next_index++) {
+                    func(index);
+                }
+            };
 
-        explicit Router(const Graph& graph);
+            const size_t workers_count = std::max<size_t>(1, std::min(thread_count, count));
+            std::vector<std::thread> helpers;
+            helpers.reserve(workers_count - 1);
+            for (size_t i = 1; i < workers_count; ++i) {
+                helpers.emplace_back(worker);
+            }
+            worker();
+            for (auto& helper : helpers) {
+                helper.join();
+            }
+        }
+
+    }  // namespace detail
 
+    // Общий интерфейс маршрутизаторов, чтобы ActivityProcessor мог выбирать алгоритм поиска
+    template <typename Weight>
+    class RouterBase {
+    public:
         struct RouteInfo {
             Weight weight;
             std::vector<EdgeId> edges;
         };
 
-        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+        virtual ~RouterBase() = default;
+
+        virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+    };
 
+    // Маршрутизатор с предварительным расчётом всех пар вершин (Флойд-Уоршелл).
+    // Таблица хранится двумя массивами V x V по строкам: веса путей и 32-битные номера
+    // последних рёбер. Недостижимость и отсутствие ребра обозначаются значениями-маркерами
+    // вместо std::optional. Раздельные массивы позволяют релаксировать строку векторным
+    // ядром min-plus (min_plus.h), которое выбирается по процессору при запуске.
+    // StoredWeight позволяет хранить веса в таблице компактнее, например во float
+    template <typename Weight, typename StoredWeight = Weight>
+    class Router : public RouterBase<Weight> {
     private:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+        struct RoutesInternalData {
+            std::vector<StoredWeight> weights;
+            std::vector<uint32_t> prev_edges;
         };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+        static constexpr StoredWeight UNREACHABLE_WEIGHT = std::numeric_limits<StoredWeight>::has_infinity
+            ? std::numeric_limits<StoredWeight>::infinity()
+            : std::numeric_limits<StoredWeight>::max();
+        static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+        // thread_count - число потоков для расчёта таблицы, 0 - по числу ядер
+        explicit Router(const Graph& graph, size_t thread_count = 1);
+
+        // Восстанавливает маршрутизатор по ранее рассчитанной таблице
+        Router(const Graph& graph, RoutesInternalData routes_internal_data);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+        const RoutesInternalData& GetRoutesInternalData() const;
+
+    private:
+        size_t GetIndex(VertexId vertex_from, VertexId vertex_to) const {
+            return vertex_from * vertex_count_ + vertex_to;
+        }
 
         void InitializeRoutesInternalData(const Graph& graph) {
-            const size_t vertex_count = graph.GetVertexCount();
-            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
+            if (graph.GetEdgeCount() >= NO_EDGE) {
+                throw std::length_error("Too many edges for 32-bit edge ids");
+            }
+            auto& weights = routes_internal_data_.weights;
+            auto& prev_edges = routes_internal_data_.prev_edges;
+            for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+                weights[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
+                prev_edges[GetIndex(vertex, vertex)] = NO_EDGE;
                 for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                    const auto& edge = graph.GetEdge(edge_id);
-                    if (edge.weight < ZERO_WEIGHT) {
+                    if (graph.GetEdgeWeight(edge_id) < Weight{}) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
-                    auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{ edge.weight, edge_id };
+                    const size_t index = GetIndex(vertex, graph.GetEdgeTarget(edge_id));
+                    const StoredWeight edge_weight = static_cast<StoredWeight>(graph.GetEdgeWeight(edge_id));
+                    if (weights[index] > edge_weight) {
+                        weights[index] = edge_weight;
+                        prev_edges[index] = static_cast<uint32_t>(edge_id);
                     }
                 }
             }
         }
 
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-            const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = { candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+        // Релаксирует отрезок строки from через вершину through. Новое последнее ребро пути
+        // from -> to - последнее ребро пути through -> to: путь through -> through пустой,
+        // но через него вес никогда не улучшается
+        void RelaxRowThroughVertex(StoredWeight* weights_from, uint32_t* prev_from,
+            const StoredWeight* weights_through, const uint32_t* prev_through, StoredWeight through_weight, size_t count) const {
+            if constexpr (std::is_floating_point_v<StoredWeight>) {
+                min_plus_row_kernel_(weights_from, prev_from, weights_through, prev_through, through_weight, count);
+            }
+            else {
+                // У целых весов нет бесконечности: сумма с маркером переполнилась бы
+                for (size_t i = 0; i < count; ++i) {
+                    if (weights_through[i] != UNREACHABLE_WEIGHT && through_weight + weights_through[i] < weights_from[i]) {
+                        weights_from[i] = through_weight + weights_through[i];
+                        prev_from[i] = prev_through[i];
+                    }
+                }
             }
         }
 
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                        }
+        // Релаксирует блок [block_from] x [block_to] через вершины блока block_through
+        void RelaxBlockThroughBlock(size_t block_from, size_t block_to, size_t block_through) {
+            const VertexId from_end = std::min(vertex_count_, (block_from + 1) * BLOCK_SIZE);
+            const VertexId to_begin = block_to * BLOCK_SIZE;
+            const VertexId to_end = std::min(vertex_count_, (block_to + 1) * BLOCK_SIZE);
+            const VertexId through_end = std::min(vertex_count_, (block_through + 1) * BLOCK_SIZE);
+            auto& weights = routes_internal_data_.weights;
+            auto& prev_edges = routes_internal_data_.prev_edges;
+
+            for (VertexId vertex_through = block_through * BLOCK_SIZE; vertex_through < through_end; ++vertex_through) {
+                const size_t row_through = GetIndex(vertex_through, to_begin);
+                for (VertexId vertex_from = block_from * BLOCK_SIZE; vertex_from < from_end; ++vertex_from) {
+                    const StoredWeight through_weight = weights[GetIndex(vertex_from, vertex_through)];
+                    if (through_weight == UNREACHABLE_WEIGHT) {
+                        continue;
                     }
+                    const size_t row_from = GetIndex(vertex_from, to_begin);
+                    RelaxRowThroughVertex(&weights[row_from], &prev_edges[row_from],
+                        &weights[row_through], &prev_edges[row_through], through_weight, to_end - to_begin);
                 }
             }
         }
 
-        static constexpr Weight ZERO_WEIGHT{};
+        // Блочный Флойд-Уоршелл: для каждого блока промежуточных вершин сначала считается
+        // диагональный блок, затем блоки его строки и столбца, затем все остальные.
+        // Блоки внутри второй и третьей фазы независимы и считаются параллельно
+        void RelaxRoutesInternalData(size_t thread_count) {
+            const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            for (size_t block_through = 0; block_through < block_count; ++block_through) {
+                RelaxBlockThroughBlock(block_through, block_through, block_through);
+
+                detail::ParallelFor(2 * block_count, thread_count, [&](size_t index) {
+                    const size_t block = index / 2;
+                    if (block == block_through) {
+                        return;
+                    }
+                    if (index % 2 == 0) {
+                        RelaxBlockThroughBlock(block_through, block, block_through);
+                    }
+                    else {
+                        RelaxBlockThroughBlock(block, block_through, block_through);
+                    }
+                });
+
+                detail::ParallelFor(block_count * block_count, thread_count, [&](size_t index) {
+                    const size_t block_from = index / block_count;
+                    const size_t block_to = index % block_count;
+                    if (block_from == block_through || block_to == block_through) {
+                        return;
+                    }
+                    RelaxBlockThroughBlock(block_from, block_to, block_through);
+                });
+            }
+        }
+
+        static constexpr size_t BLOCK_SIZE = 64;
+        static constexpr StoredWeight ZERO_WEIGHT{};
         const Graph& graph_;
+        size_t vertex_count_;
         RoutesInternalData routes_internal_data_;
+        detail::MinPlusRowKernel<StoredWeight> min_plus_row_kernel_ = nullptr;
     };
 
-    template <typename Weight>
-    Router<Weight>::Router(const Graph& graph)
+    template <typename Weight, typename StoredWeight>
+    Router<Weight, StoredWeight>::Router(const Graph& graph, size_t thread_count)
         : graph_(graph)
-        , routes_internal_data_(graph.GetVertexCount(),
-            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+        , vertex_count_(graph.GetVertexCount())
+        , routes_internal_data_{ std::vector<StoredWeight>(vertex_count_ * vertex_count_, UNREACHABLE_WEIGHT),
+                                 std::vector<uint32_t>(vertex_count_ * vertex_count_, NO_EDGE) }
     {
+        if constexpr (std::is_floating_point_v<StoredWeight>) {
+            min_plus_row_kernel_ = detail::SelectMinPlusRowKernel<StoredWeight>();
+        }
         InitializeRoutesInternalData(graph);
 
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
         }
+        RelaxRoutesInternalData(thread_count);
     }
 
-    template <typename Weight>
-    std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
+    template <typename Weight, typename StoredWeight>
+    Router<Weight, StoredWeight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+        : graph_(graph)
+        , vertex_count_(graph.GetVertexCount())
+        , routes_internal_data_(std::move(routes_internal_data))
+    {
+        if (routes_internal_data_.weights.size() != vertex_count_ * vertex_count_
+            || routes_internal_data_.prev_edges.size() != vertex_count_ * vertex_count_) {
+            throw std::invalid_argument("Routes table size doesn't match the graph");
+        }
+    }
+
+    template <typename Weight, typename StoredWeight>
+    std::optional<typename Router<Weight, StoredWeight>::RouteInfo> Router<Weight, StoredWeight>::BuildRoute(VertexId from,
         VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const StoredWeight stored_weight = routes_internal_data_.weights[GetIndex(from, to)];
+        if (stored_weight == UNREACHABLE_WEIGHT) {
             return std::nullopt;
         }
-        const Weight weight = route_internal_data->weight;
+        const Weight weight = static_cast<Weight>(stored_weight);
         std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-            edge_id;
-            edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+        for (uint32_t edge_id = routes_internal_data_.prev_edges[GetIndex(from, to)];
+            edge_id != NO_EDGE;
+            edge_id = routes_internal_data_.prev_edges[GetIndex(from, graph_.GetEdgeSource(edge_id))])
         {
-            edges.push_back(*edge_id);
+            edges.push_back(edge_id);
         }
         std::reverse(edges.begin(), edges.end());
 
         return RouteInfo{ weight, std::move(edges) };
     }
 
+    template <typename Weight, typename StoredWeight>
+    const typename Router<Weight, StoredWeight>::RoutesInternalData& Router<Weight, StoredWeight>::GetRoutesInternalData() const {
+        return routes_internal_data_;
+    }
+
 }  // namespace graph
\ No newline at end of file
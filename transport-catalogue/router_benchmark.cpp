@@ -0,0 +1,102 @@
+// Масштабирование расчёта таблицы PRECOMPUTED по числу потоков (router_threads).
+// Строит синтетическую сеть, затем для каждого числа потоков заново строит граф и
+// таблицу маршрутизатора и печатает время и ускорение относительно первого запуска.
+// Запуск: router_benchmark [stops=5000] [buses=1500] [threads...=1 2 4 8]
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::literals;
+
+namespace {
+
+    // Сеть как у генератора тестов: остановки в прямоугольнике, маршруты из 2-12 случайных
+    // остановок, дорожное расстояние - географическое с коэффициентом 1.1-1.6
+    transport_catalogue::TransportCatalogue MakeNetwork(size_t stop_count, size_t bus_count) {
+        mt19937 generator(42);
+        uniform_real_distribution<double> unit(0.0, 1.0);
+
+        transport_catalogue::TransportCatalogue tc;
+        vector<string> names;
+        names.reserve(stop_count);
+        for (size_t i = 0; i < stop_count; ++i) {
+            names.push_back("S"s + to_string(i));
+            tc.AddStop({ names.back(), { 55.5 + unit(generator) * 0.4, 37.3 + unit(generator) * 0.6 } });
+        }
+
+        vector<domain::StopDistancesDescription> distances(stop_count);
+        uniform_int_distribution<size_t> pick_stop(0, stop_count - 1);
+        uniform_int_distribution<size_t> pick_length(2, 12);
+        for (size_t b = 0; b < bus_count; ++b) {
+            domain::BusDescription bus;
+            bus.bus_name = "B"s + to_string(b);
+            bus.type = unit(generator) < 0.4 ? "true"s : "false"s;
+            vector<size_t> stops;
+            for (size_t length = pick_length(generator); stops.size() < length;) {
+                stops.push_back(pick_stop(generator));
+            }
+            if (bus.type == "true"s) {
+                stops.push_back(stops.front());
+            }
+            for (size_t i = 0; i < stops.size(); ++i) {
+                bus.stops.push_back(names[stops[i]]);
+                if (i + 1 < stops.size() && stops[i] != stops[i + 1]) {
+                    const auto& from = tc.GetStops()[stops[i]];
+                    const auto& to = tc.GetStops()[stops[i + 1]];
+                    const double road = geo::ComputeDistance(from.coordinates, to.coordinates) * (1.1 + unit(generator) * 0.5);
+                    distances[stops[i]].distances.emplace_back(names[stops[i + 1]], static_cast<int>(road) + 1);
+                }
+            }
+            tc.AddBus(bus);
+        }
+        for (size_t i = 0; i < stop_count; ++i) {
+            distances[i].stop_name = names[i];
+            tc.AddStopDistance(distances[i]);
+        }
+        tc.IndexRoutes();
+        return tc;
+    }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t stop_count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5000;
+    const size_t bus_count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1500;
+    vector<size_t> thread_counts;
+    for (int i = 3; i < argc; ++i) {
+        thread_counts.push_back(strtoul(argv[i], nullptr, 10));
+    }
+    if (thread_counts.empty()) {
+        thread_counts = { 1, 2, 4, 8 };
+    }
+
+    transport_catalogue::TransportCatalogue tc = MakeNetwork(stop_count, bus_count);
+    domain::RouteSettings settings;
+    settings.router_type = domain::RouterType::PRECOMPUTED;
+
+    cout << "stops "sv << stop_count << ", buses "sv << bus_count
+         << ", hardware threads "sv << thread::hardware_concurrency() << '\n';
+    cout << "threads\tseconds\tspeedup\n"sv;
+    double base_seconds = 0;
+    for (const size_t threads : thread_counts) {
+        settings.router_threads = threads;
+        tc.AddRouteSettings(settings);
+
+        const auto start = chrono::steady_clock::now();
+        const graph::ActivityProcessor processor(tc);
+        const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (base_seconds == 0) {
+            base_seconds = seconds;
+        }
+        cout << threads << '\t' << fixed << setprecision(3) << seconds << '\t'
+             << setprecision(2) << base_seconds / seconds << '\n';
+    }
+}
@@ -1,13 +1,9 @@
 #include "serialization.h"
 
-namespace serialization {
-
-    template <typename It>
-    uint32_t calculate_id(It start, It end, std::string_view name) {
+#include <algorithm>
+#include <type_traits>
 
-        auto stop_it = std::find_if(start, end, [&name](const domain::Stop stop) {return stop.stop_name == name; });
-        return std::distance(start, stop_it);
-    }
+namespace serialization {
 
     transport_catalogue_protobuf::TransportCatalogue transport_catalogue_serialization(const transport_catalogue::TransportCatalogue& transport_catalogue) {
 
@@ -17,19 +13,16 @@ namespace serialization {
         const auto& buses = transport_catalogue.GetBuses(); 
         const auto& distances = transport_catalogue.GetStopDistances(); 
 
-        int id = 0;
         for (const auto& stop : stops) {
 
             transport_catalogue_protobuf::Stop stop_proto;
 
-            stop_proto.set_id(id);
+            stop_proto.set_id(stop.id);
             stop_proto.set_name(stop.stop_name);
             stop_proto.set_latitude(stop.coordinates.lat);
             stop_proto.set_longitude(stop.coordinates.lng);
 
             *transport_catalogue_proto.add_stops() = std::move(stop_proto);
-
-            ++id;
         }
 
         for (const auto& bus : buses) {
@@ -38,36 +31,28 @@ namespace serialization {
 
             bus_proto.set_name(bus.bus_name);
 
-            for (auto stop : bus.stops) {
-                uint32_t stop_id = calculate_id(stops.cbegin(),
-                                                stops.cend(),
-                                                stop);
-                bus_proto.add_stops(stop_id);
-            }
+            *bus_proto.mutable_stops() = {bus.stops.begin(), bus.stops.end()};
 
             bus_proto.set_is_roundtrip(bus.type);
-            domain::AllBusInfoBusResponse allbusresp = transport_catalogue.GetAllBusInfo(bus.bus_name);
-            bus_proto.set_route_length(allbusresp.route_length);
+            bus_proto.set_route_length(bus.stats.route_length);
+            bus_proto.set_stop_count(bus.stats.stop_count);
+            bus_proto.set_unique_stop_count(bus.stats.unique_stop_count);
+            bus_proto.set_route_curvature(bus.stats.route_curvature);
 
             *transport_catalogue_proto.add_buses() = std::move(bus_proto);
         }
 
-        for (const auto& [pair_stops, pair_distance] : distances) {
+        distances.ForEach([&transport_catalogue_proto](uint32_t start, uint32_t end, int distance) {
 
             transport_catalogue_protobuf::Distance distance_proto;
 
-            distance_proto.set_start(calculate_id(stops.cbegin(),
-                                                  stops.cend(),
-                                                  pair_stops.first->stop_name));
-
-            distance_proto.set_end(calculate_id(stops.cbegin(),
-                                                stops.cend(),
-                                                pair_stops.second->stop_name));
+            distance_proto.set_start(start);
+            distance_proto.set_end(end);
 
-            distance_proto.set_distance(pair_distance);
+            distance_proto.set_distance(distance);
 
             *transport_catalogue_proto.add_distances() = std::move(distance_proto);
-        }
+        });
 
         return transport_catalogue_proto;
     }
@@ -99,8 +84,8 @@ namespace serialization {
 
             domain::Distance tc_distance;
 
-            tc_distance.start = transport_catalogue.FindStop(tc_stops[distance.start()].stop_name);
-            tc_distance.end = transport_catalogue.FindStop(tc_stops[distance.end()].stop_name);
+            tc_distance.start = &tc_stops[distance.start()];
+            tc_distance.end = &tc_stops[distance.end()];
 
             tc_distance.distance = distance.distance();
 
@@ -111,18 +96,18 @@ namespace serialization {
 
         for (const auto& bus_proto : buses_proto) {
 
-            domain::BusDescription tc_bus;
+            domain::Bus tc_bus;
 
             tc_bus.bus_name = bus_proto.name();
-
-            for (auto stop_id : bus_proto.stops()) {
-                auto name = tc_stops[stop_id].stop_name;
-                tc_bus.stops.push_back(transport_catalogue.FindStop(name)->stop_name);
-            }
-
+            tc_bus.stops.assign(bus_proto.stops().begin(), bus_proto.stops().end());
             tc_bus.type = bus_proto.is_roundtrip();
-            transport_catalogue.AddBus(tc_bus);
+            tc_bus.stats.stop_count = static_cast<int>(bus_proto.stop_count());
+            tc_bus.stats.unique_stop_count = static_cast<int>(bus_proto.unique_stop_count());
+            tc_bus.stats.route_length = static_cast<int>(bus_proto.route_length());
+            tc_bus.stats.route_curvature = bus_proto.route_curvature();
+            transport_catalogue.AddBus(std::move(tc_bus));
         }
+        transport_catalogue.IndexRoutes();
 
         return transport_catalogue;
     }
@@ -254,6 +239,13 @@ namespace serialization {
 
         routing_settings_proto.set_bus_wait_time(routing_settings.bus_wait_time);
         routing_settings_proto.set_bus_velocity(routing_settings.bus_velocity);
+        routing_settings_proto.set_router_type(static_cast<transport_catalogue_protobuf::RouterType>(routing_settings.router_type));
+        routing_settings_proto.set_router_threads(routing_settings.router_threads);
+        routing_settings_proto.set_router_float_weights(routing_settings.router_float_weights);
+        routing_settings_proto.set_graph_model(static_cast<transport_catalogue_protobuf::GraphModel>(routing_settings.graph_model));
+        routing_settings_proto.set_router_landmarks(routing_settings.router_landmarks);
+        routing_settings_proto.set_router_queue(static_cast<transport_catalogue_protobuf::QueueType>(routing_settings.router_queue));
+        routing_settings_proto.set_router_cache_bytes(routing_settings.router_cache_bytes);
 
         return routing_settings_proto;
     }
@@ -264,13 +256,272 @@ namespace serialization {
 
         routing_settings.bus_wait_time = routing_settings_proto.bus_wait_time();
         routing_settings.bus_velocity = routing_settings_proto.bus_velocity();
+        routing_settings.router_type = static_cast<domain::RouterType>(routing_settings_proto.router_type());
+        routing_settings.router_threads = routing_settings_proto.router_threads();
+        routing_settings.router_float_weights = routing_settings_proto.router_float_weights();
+        routing_settings.graph_model = static_cast<domain::GraphModel>(routing_settings_proto.graph_model());
+        routing_settings.router_landmarks = routing_settings_proto.router_landmarks();
+        routing_settings.router_queue = static_cast<domain::QueueType>(routing_settings_proto.router_queue());
+        routing_settings.router_cache_bytes = routing_settings_proto.router_cache_bytes();
 
         return routing_settings;
     }
 
+    transport_catalogue_protobuf::Graph graph_serialization(const graph::DirectedWeightedGraph<graph::RouteWeight>& graph) {
+
+        transport_catalogue_protobuf::Graph graph_proto;
+
+        graph_proto.set_vertex_count(graph.GetVertexCount());
+
+        for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph.GetEdge(edge_id);
+
+            transport_catalogue_protobuf::Edge edge_proto;
+
+            edge_proto.set_from(edge.from);
+            edge_proto.set_to(edge.to);
+            edge_proto.set_weight(edge.weight);
+            edge_proto.set_stop_count(edge.stop_count);
+            edge_proto.set_name_id(edge.name_id);
+            edge_proto.set_distance(edge.distance);
+            edge_proto.set_wait_count(edge.wait_count);
+
+            *graph_proto.add_edges() = std::move(edge_proto);
+        }
+
+        return graph_proto;
+    }
+
+    graph::DirectedWeightedGraph<graph::RouteWeight> graph_deserialization(const transport_catalogue_protobuf::Graph& graph_proto) {
+
+        graph::DirectedWeightedGraph<graph::RouteWeight> graph(graph_proto.vertex_count());
+
+        for (const auto& edge_proto : graph_proto.edges()) {
+            graph.AddEdge({edge_proto.from(),
+                           edge_proto.to(),
+                           static_cast<graph::RouteWeight>(edge_proto.weight()),
+                           edge_proto.name_id(),
+                           static_cast<int>(edge_proto.stop_count()),
+                           static_cast<int>(edge_proto.distance()),
+                           static_cast<int>(edge_proto.wait_count())});
+        }
+        graph.Freeze();
+
+        return graph;
+    }
+
+    // Поле таблицы весов PRECOMPUTED для типа StoredWeight: float и фиксированная точка
+    // хранятся как есть, без расширения до double
+    template <typename StoredWeight>
+    const auto& route_weights_field(const transport_catalogue_protobuf::Router& router_proto) {
+        if constexpr (std::is_same_v<StoredWeight, float>) {
+            return router_proto.route_weights_float();
+        } else if constexpr (std::is_same_v<StoredWeight, uint32_t>) {
+            return router_proto.route_weights_fixed();
+        } else {
+            static_assert(std::is_same_v<StoredWeight, double>, "unsupported routes table weight");
+            return router_proto.route_weights();
+        }
+    }
+
+    template <typename StoredWeight>
+    auto* mutable_route_weights_field(transport_catalogue_protobuf::Router& router_proto) {
+        if constexpr (std::is_same_v<StoredWeight, float>) {
+            return router_proto.mutable_route_weights_float();
+        } else if constexpr (std::is_same_v<StoredWeight, uint32_t>) {
+            return router_proto.mutable_route_weights_fixed();
+        } else {
+            static_assert(std::is_same_v<StoredWeight, double>, "unsupported routes table weight");
+            return router_proto.mutable_route_weights();
+        }
+    }
+
+    template <typename StoredWeight>
+    bool routes_table_serialization(const graph::RouterBase<graph::RouteWeight>& router, transport_catalogue_protobuf::Router& router_proto) {
+
+        const auto* precomputed_router = dynamic_cast<const graph::Router<graph::RouteWeight, StoredWeight>*>(&router);
+        if (!precomputed_router) {
+            return false;
+        }
+
+        const auto& routes_internal_data = precomputed_router->GetRoutesInternalData();
+        *mutable_route_weights_field<StoredWeight>(router_proto) = {routes_internal_data.weights.begin(), routes_internal_data.weights.end()};
+        *router_proto.mutable_route_prev_edges() = {routes_internal_data.prev_edges.begin(), routes_internal_data.prev_edges.end()};
+
+        return true;
+    }
+
+    template <typename StoredWeight>
+    typename graph::Router<graph::RouteWeight, StoredWeight>::RoutesInternalData routes_table_deserialization(const transport_catalogue_protobuf::Router& router_proto) {
+
+        const auto& weights_proto = route_weights_field<StoredWeight>(router_proto);
+        if (weights_proto.size() != router_proto.route_prev_edges_size()) {
+            throw std::runtime_error("corrupted routes table in serialized file");
+        }
+
+        typename graph::Router<graph::RouteWeight, StoredWeight>::RoutesInternalData routes_internal_data;
+        routes_internal_data.weights.assign(weights_proto.begin(), weights_proto.end());
+        routes_internal_data.prev_edges.assign(router_proto.route_prev_edges().begin(), router_proto.route_prev_edges().end());
+
+        return routes_internal_data;
+    }
+
+    bool hierarchy_serialization(const graph::RouterBase<graph::RouteWeight>& router, transport_catalogue_protobuf::Router& router_proto) {
+
+        const auto* ch_router = dynamic_cast<const graph::ContractionHierarchy<graph::RouteWeight>*>(&router);
+        if (!ch_router) {
+            return false;
+        }
+
+        const auto& hierarchy = ch_router->GetHierarchy();
+        auto& hierarchy_proto = *router_proto.mutable_contraction_hierarchy();
+        hierarchy_proto.mutable_ranks()->Reserve(hierarchy.ranks.size());
+        for (const uint32_t rank : hierarchy.ranks) {
+            hierarchy_proto.add_ranks(rank);
+        }
+
+        hierarchy_proto.mutable_shortcuts()->Reserve(hierarchy.shortcuts.size());
+        for (const auto& shortcut : hierarchy.shortcuts) {
+
+            transport_catalogue_protobuf::Shortcut shortcut_proto;
+
+            shortcut_proto.set_from(shortcut.from);
+            shortcut_proto.set_to(shortcut.to);
+            shortcut_proto.set_weight(shortcut.weight);
+            shortcut_proto.set_first(shortcut.first);
+            shortcut_proto.set_second(shortcut.second);
+
+            *hierarchy_proto.add_shortcuts() = std::move(shortcut_proto);
+        }
+
+        return true;
+    }
+
+    graph::ContractionHierarchy<graph::RouteWeight>::Hierarchy hierarchy_deserialization(const transport_catalogue_protobuf::ContractionHierarchy& hierarchy_proto) {
+
+        graph::ContractionHierarchy<graph::RouteWeight>::Hierarchy hierarchy;
+
+        hierarchy.ranks.assign(hierarchy_proto.ranks().begin(), hierarchy_proto.ranks().end());
+
+        hierarchy.shortcuts.reserve(hierarchy_proto.shortcuts_size());
+        for (const auto& shortcut_proto : hierarchy_proto.shortcuts()) {
+            hierarchy.shortcuts.push_back({shortcut_proto.from(),
+                                           shortcut_proto.to(),
+                                           static_cast<graph::RouteWeight>(shortcut_proto.weight()),
+                                           shortcut_proto.first(),
+                                           shortcut_proto.second()});
+        }
+
+        return hierarchy;
+    }
+
+    transport_catalogue_protobuf::Landmarks landmarks_serialization(const graph::LandmarkTables<graph::RouteWeight>& landmarks) {
+
+        transport_catalogue_protobuf::Landmarks landmarks_proto;
+
+        for (const graph::VertexId vertex : landmarks.landmarks) {
+            landmarks_proto.add_vertices(vertex);
+        }
+        if constexpr (std::is_same_v<graph::RouteWeight, uint32_t>) {
+            *landmarks_proto.mutable_from_landmarks_fixed() = {landmarks.from_landmarks.begin(), landmarks.from_landmarks.end()};
+            *landmarks_proto.mutable_to_landmarks_fixed() = {landmarks.to_landmarks.begin(), landmarks.to_landmarks.end()};
+        } else {
+            *landmarks_proto.mutable_from_landmarks() = {landmarks.from_landmarks.begin(), landmarks.from_landmarks.end()};
+            *landmarks_proto.mutable_to_landmarks() = {landmarks.to_landmarks.begin(), landmarks.to_landmarks.end()};
+        }
+
+        return landmarks_proto;
+    }
+
+    graph::LandmarkTables<graph::RouteWeight> landmarks_deserialization(const transport_catalogue_protobuf::Landmarks& landmarks_proto,
+                                                                        size_t vertex_count) {
+
+        graph::LandmarkTables<graph::RouteWeight> landmarks;
+
+        landmarks.landmarks.assign(landmarks_proto.vertices().begin(), landmarks_proto.vertices().end());
+        if constexpr (std::is_same_v<graph::RouteWeight, uint32_t>) {
+            landmarks.from_landmarks.assign(landmarks_proto.from_landmarks_fixed().begin(), landmarks_proto.from_landmarks_fixed().end());
+            landmarks.to_landmarks.assign(landmarks_proto.to_landmarks_fixed().begin(), landmarks_proto.to_landmarks_fixed().end());
+        } else {
+            landmarks.from_landmarks.assign(landmarks_proto.from_landmarks().begin(), landmarks_proto.from_landmarks().end());
+            landmarks.to_landmarks.assign(landmarks_proto.to_landmarks().begin(), landmarks_proto.to_landmarks().end());
+        }
+
+        // GetPotential читает по k значений на каждую вершину графа
+        const size_t table_size = vertex_count * landmarks.landmarks.size();
+        if (landmarks.from_landmarks.size() != table_size || landmarks.to_landmarks.size() != table_size
+            || std::any_of(landmarks.landmarks.begin(), landmarks.landmarks.end(),
+                           [vertex_count](graph::VertexId vertex) { return vertex >= vertex_count; })) {
+            throw std::runtime_error("corrupted landmark tables in serialized file");
+        }
+
+        return landmarks;
+    }
+
+    transport_catalogue_protobuf::Router router_serialization(const transport_catalogue::TransportCatalogue& transport_catalogue,
+                                                              const graph::ActivityProcessor& activity_processor) {
+
+        transport_catalogue_protobuf::Router router_proto;
+
+        *router_proto.mutable_graph() = graph_serialization(activity_processor.GetGraph());
+
+        for (const auto& [stop_name, vertex_id] : activity_processor.GetStopToVertex()) {
+
+            transport_catalogue_protobuf::StopVertex stop_vertex_proto;
+
+            stop_vertex_proto.set_stop_id(transport_catalogue.FindStop(stop_name)->id);
+            stop_vertex_proto.set_vertex_id(vertex_id);
+
+            *router_proto.add_stop_vertices() = std::move(stop_vertex_proto);
+        }
+
+        if (const auto* router = activity_processor.GetRouter()) {
+            if (!routes_table_serialization<graph::RouteWeight>(*router, router_proto)
+                && !routes_table_serialization<float>(*router, router_proto)) {
+                hierarchy_serialization(*router, router_proto);
+            }
+        }
+
+        if (const auto* landmarks = activity_processor.GetLandmarks()) {
+            *router_proto.mutable_landmarks() = landmarks_serialization(*landmarks);
+        }
+
+        return router_proto;
+    }
+
+    graph::RoutingData router_deserialization(const transport_catalogue_protobuf::Router& router_proto,
+                                              const transport_catalogue::TransportCatalogue& transport_catalogue,
+                                              const domain::RouteSettings& routing_settings) {
+
+        graph::RoutingData routing_data;
+
+        routing_data.graph = graph_deserialization(router_proto.graph());
+
+        const auto& tc_stops = transport_catalogue.GetStops();
+        for (const auto& stop_vertex_proto : router_proto.stop_vertices()) {
+            routing_data.stop_to_vertex.emplace(tc_stops[stop_vertex_proto.stop_id()].stop_name,
+                                                stop_vertex_proto.vertex_id());
+        }
+
+        if (routing_settings.router_type == domain::RouterType::PRECOMPUTED) {
+            if (routing_settings.router_float_weights) {
+                routing_data.routes_table = routes_table_deserialization<float>(router_proto);
+            } else {
+                routing_data.routes_table = routes_table_deserialization<graph::RouteWeight>(router_proto);
+            }
+        } else if (routing_settings.router_type == domain::RouterType::CONTRACTION_HIERARCHIES) {
+            routing_data.routes_table = hierarchy_deserialization(router_proto.contraction_hierarchy());
+        } else if (routing_settings.router_type == domain::RouterType::ALT) {
+            routing_data.routes_table = landmarks_deserialization(router_proto.landmarks(), routing_data.graph.GetVertexCount());
+        }
+
+        return routing_data;
+    }
+
     void catalogue_serialization(const transport_catalogue::TransportCatalogue& transport_catalogue,
                                  const transport_catalogue::RenderSettings& render_settings,
                                  const domain::RouteSettings& routing_settings,
+                                 const graph::ActivityProcessor& activity_processor,
                                  std::ostream& out) {
 
         transport_catalogue_protobuf::Catalogue catalogue_proto;
@@ -282,6 +533,7 @@ namespace serialization {
         *catalogue_proto.mutable_transport_catalogue() = std::move(transport_catalogue_proto);
         *catalogue_proto.mutable_render_settings() = std::move(render_settings_proto);
         *catalogue_proto.mutable_routing_settings() = std::move(routing_settings_proto);
+        *catalogue_proto.mutable_router() = router_serialization(transport_catalogue, activity_processor);
 
         catalogue_proto.SerializePartialToOstream(&out);
 
@@ -289,15 +541,31 @@ namespace serialization {
 
     Catalogue catalogue_deserialization(std::istream& in) {
 
-        transport_catalogue_protobuf::Catalogue catalogue_proto;
+        transport_catalogue_protobuf::CatalogueWithRawRouter catalogue_proto;
         auto success_parsing_catalogue_from_istream = catalogue_proto.ParseFromIstream(&in);
 
         if (!success_parsing_catalogue_from_istream) {
             throw std::runtime_error("cannot parse serialized file from istream");
         }
 
-        return {transport_catalogue_deserialization(catalogue_proto.transport_catalogue()),
-                render_settings_deserialization(catalogue_proto.render_settings()),
-                routing_settings_deserialization(catalogue_proto.routing_settings())};
+        transport_catalogue::TransportCatalogue transport_catalogue = transport_catalogue_deserialization(catalogue_proto.transport_catalogue());
+        domain::RouteSettings routing_settings = routing_settings_deserialization(catalogue_proto.routing_settings());
+        transport_catalogue.AddRouteSettings(routing_settings);
+
+        return Catalogue{std::move(transport_catalogue).Freeze(),
+                         render_settings_deserialization(catalogue_proto.render_settings()),
+                         routing_settings,
+                         std::move(*catalogue_proto.mutable_router())};
+    }
+
+    graph::RoutingData routing_data_deserialization(const Catalogue& catalogue) {
+
+        transport_catalogue_protobuf::Router router_proto;
+        if (!router_proto.ParseFromString(catalogue.serialized_router_)) {
+            throw std::runtime_error("cannot parse serialized router");
+        }
+
+        // Вершины графа ссылаются на названия остановок уже заполненного справочника
+        return router_deserialization(router_proto, *catalogue.transport_catalogue_, catalogue.routing_settings_);
     }
 }//end namespace serialization
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "transport_router.h"
 #include "transport_router.pb.h"
+#include "graph.pb.h"
 
 #include <iostream>
 
@@ -18,14 +19,12 @@ namespace serialization {
     struct SerializationSettings {std::string file_name;};
 
     struct Catalogue {
-        transport_catalogue::TransportCatalogue transport_catalogue_;
+        std::shared_ptr<const transport_catalogue::TransportCatalogue> transport_catalogue_;  // снимок с настройками маршрутизации
         transport_catalogue::RenderSettings render_settings_;
         domain::RouteSettings routing_settings_;
+        std::string serialized_router_;  // сообщение Router, разбирается routing_data_deserialization
     };
 
-    template <typename It>
-    uint32_t calculate_id(It start, It end, std::string_view name);
-
     transport_catalogue_protobuf::TransportCatalogue transport_catalogue_serialization(const transport_catalogue::TransportCatalogue& transport_catalogue);
     transport_catalogue::TransportCatalogue transport_catalogue_deserialization(const transport_catalogue_protobuf::TransportCatalogue& transport_catalogue_proto);
 
@@ -37,11 +36,23 @@ namespace serialization {
     transport_catalogue_protobuf::RouteSettings routing_settings_serialization(const domain::RouteSettings& routing_settings);
     domain::RouteSettings routing_settings_deserialization(const transport_catalogue_protobuf::RouteSettings& routing_settings_proto);
 
+    transport_catalogue_protobuf::Graph graph_serialization(const graph::DirectedWeightedGraph<graph::RouteWeight>& graph);
+    graph::DirectedWeightedGraph<graph::RouteWeight> graph_deserialization(const transport_catalogue_protobuf::Graph& graph_proto);
+
+    transport_catalogue_protobuf::Router router_serialization(const transport_catalogue::TransportCatalogue& transport_catalogue,
+                                                              const graph::ActivityProcessor& activity_processor);
+    graph::RoutingData router_deserialization(const transport_catalogue_protobuf::Router& router_proto,
+                                              const transport_catalogue::TransportCatalogue& transport_catalogue,
+                                              const domain::RouteSettings& routing_settings);
+
     void catalogue_serialization(const transport_catalogue::TransportCatalogue& transport_catalogue,
                                  const transport_catalogue::RenderSettings& render_settings,
                                  const domain::RouteSettings& routing_settings,
+                                 const graph::ActivityProcessor& activity_processor,
                                  std::ostream& out);
 
+    // Читает справочник и настройки; данные маршрутизации остаются неразобранными
     Catalogue catalogue_deserialization(std::istream& in);
+    graph::RoutingData routing_data_deserialization(const Catalogue& catalogue);
 
 }//end namespace serialization
\ No newline at end of file
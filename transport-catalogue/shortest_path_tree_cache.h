@@ -0,0 +1,91 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Дерево кратчайших путей от одной вершины: вес пути и последнее ребро для каждой вершины
+    template <typename Weight>
+    struct ShortestPathTree {
+        static constexpr Weight UNREACHABLE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+            ? std::numeric_limits<Weight>::infinity()
+            : std::numeric_limits<Weight>::max();
+        static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+        std::vector<Weight> weights;
+        std::vector<uint32_t> prev_edges;
+
+        size_t GetByteSize() const {
+            return weights.size() * sizeof(Weight) + prev_edges.size() * sizeof(uint32_t);
+        }
+    };
+
+    struct ShortestPathTreeCacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t size_bytes = 0;  // сколько занимают деревья в кэше сейчас
+    };
+
+    // Кэш деревьев кратчайших путей по вершине-началу с вытеснением давно не использованных
+    // (LRU). Объём ограничен в байтах: дерево больше всего лимита не сохраняется.
+    // Как и буферы маршрутизаторов, не потокобезопасен
+    template <typename Weight>
+    class ShortestPathTreeCache {
+    public:
+        using Tree = ShortestPathTree<Weight>;
+
+        explicit ShortestPathTreeCache(size_t capacity_bytes)
+            : capacity_bytes_(capacity_bytes) {
+        }
+
+        // nullptr, если дерева нет; найденное дерево становится самым свежим
+        std::shared_ptr<const Tree> Find(VertexId source) {
+            const auto it = index_.find(source);
+            if (it == index_.end()) {
+                ++stats_.misses;
+                return nullptr;
+            }
+            ++stats_.hits;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->second;
+        }
+
+        void Insert(VertexId source, std::shared_ptr<const Tree> tree) {
+            const size_t tree_bytes = tree->GetByteSize();
+            if (tree_bytes > capacity_bytes_ || index_.count(source) > 0) {
+                return;
+            }
+            while (stats_.size_bytes + tree_bytes > capacity_bytes_) {
+                stats_.size_bytes -= entries_.back().second->GetByteSize();
+                index_.erase(entries_.back().first);
+                entries_.pop_back();
+                ++stats_.evictions;
+            }
+            entries_.emplace_front(source, std::move(tree));
+            index_.emplace(source, entries_.begin());
+            stats_.size_bytes += tree_bytes;
+        }
+
+        const ShortestPathTreeCacheStats& GetStats() const {
+            return stats_;
+        }
+
+    private:
+        using Entry = std::pair<VertexId, std::shared_ptr<const Tree>>;
+
+        size_t capacity_bytes_;
+        std::list<Entry> entries_;  // от самого свежего к самому давнему
+        std::unordered_map<VertexId, typename std::list<Entry>::iterator> index_;
+        ShortestPathTreeCacheStats stats_;
+    };
+
+}  // namespace graph
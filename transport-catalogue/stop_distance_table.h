@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace transport_catalogue {
+
+	// Дорожные расстояния между остановками по паре индексов (откуда, куда).
+	// Открытая адресация с линейным пробированием в одном массиве: ключ - оба индекса,
+	// упакованные в 64 бита, поиск не разыменовывает остановки и не читает их названия
+	class StopDistanceTable {
+	public:
+		// Сохраняет расстояние, если для пары его ещё нет
+		void Insert(uint32_t from, uint32_t to, int distance) {
+			if ((size_ + 1) * 2 > slots_.size()) {
+				Grow();
+			}
+			Slot& slot = slots_[FindSlot(PackKey(from, to))];
+			if (slot.key == EMPTY_KEY) {
+				slot = { PackKey(from, to), distance };
+				++size_;
+			}
+		}
+
+		// nullptr, если расстояние для пары не задано
+		const int* Find(uint32_t from, uint32_t to) const {
+			if (slots_.empty()) {
+				return nullptr;
+			}
+			const Slot& slot = slots_[FindSlot(PackKey(from, to))];
+			return slot.key == EMPTY_KEY ? nullptr : &slot.distance;
+		}
+
+		size_t GetSize() const {
+			return size_;
+		}
+
+		// action(from, to, distance) для каждой пары, в порядке ячеек таблицы
+		template <typename Action>
+		void ForEach(Action action) const {
+			for (const Slot& slot : slots_) {
+				if (slot.key != EMPTY_KEY) {
+					action(static_cast<uint32_t>(slot.key >> 32), static_cast<uint32_t>(slot.key), slot.distance);
+				}
+			}
+		}
+
+	private:
+		struct Slot {
+			uint64_t key;
+			int distance;
+		};
+
+		// Пара (max, max) недостижима: столько остановок в справочнике не бывает
+		static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+
+		static uint64_t PackKey(uint32_t from, uint32_t to) {
+			return static_cast<uint64_t>(from) << 32 | to;
+		}
+
+		// Перемешивание из splitmix64: соседние индексы попадают в далёкие ячейки
+		static uint64_t Hash(uint64_t key) {
+			key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+			return key ^ (key >> 31);
+		}
+
+		// Ячейка с ключом или первая пустая на его пути; размер таблицы - степень двойки
+		size_t FindSlot(uint64_t key) const {
+			const size_t mask = slots_.size() - 1;
+			size_t index = Hash(key) & mask;
+			while (slots_[index].key != key && slots_[index].key != EMPTY_KEY) {
+				index = (index + 1) & mask;
+			}
+			return index;
+		}
+
+		void Grow() {
+			std::vector<Slot> old_slots(slots_.empty() ? 16 : slots_.size() * 2, Slot{ EMPTY_KEY, 0 });
+			old_slots.swap(slots_);
+			for (const Slot& slot : old_slots) {
+				if (slot.key != EMPTY_KEY) {
+					slots_[FindSlot(slot.key)] = slot;
+				}
+			}
+		}
+
+		std::vector<Slot> slots_;  // заполнены не больше чем наполовину
+		size_t size_ = 0;
+	};
+}
@@ -1,7 +1,9 @@
 #include "json_reader.h"
 #include "geo.h"
 #include "transport_catalogue.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 
 using namespace std;
@@ -10,26 +12,28 @@ namespace transport_catalogue {
 
 	void TransportCatalogue::AddBus(const BusDescription& b) {
 		Bus bptr;
-		deque <std::string_view> stops_ptr;
+		bptr.stops.reserve(b.stops.size());
 		for (const auto& stop : b.stops) {
 			auto it = stop_name_to_stop_.find(stop);
 			if (it != stop_name_to_stop_.end()) {
-				stops_ptr.push_back(it->second->stop_name);
+				bptr.stops.push_back(it->second->id);
 
 			}
 		}
 		bptr.bus_name = b.bus_name;
 		bptr.type = b.type;  
-		bptr.stops = stops_ptr;
-		buses_.push_back(bptr); 
+		AddBus(move(bptr));
+	}
+
+	void TransportCatalogue::AddBus(Bus bus) {
+		bus.id = static_cast<uint32_t>(buses_.size());
+		buses_.push_back(move(bus)); 
 		Bus* bptr_bus = &buses_.back();
 		bus_name_to_bus_.emplace(bptr_bus->bus_name, bptr_bus);
-		for (auto el : stops_ptr) {
-		stop_info_[el].insert(bptr_bus->bus_name);
-		}
 	}
 
 	void TransportCatalogue::AddStop(Stop stop) {
+		stop.id = static_cast<uint32_t>(stops_.size());
 		stops_.push_back(move(stop));
 		Stop* ptr_stop = &stops_.back();
 		stop_name_to_stop_.emplace(string_view(ptr_stop->stop_name), ptr_stop);
@@ -53,71 +57,129 @@ namespace transport_catalogue {
 
 	AllBusInfoBusResponse TransportCatalogue::GetAllBusInfo(string_view bus)  const {
 		AllBusInfoBusResponse all_r;
-		const Bus* fb = FindBus(string(bus));
+		all_r.bus_name = bus;
+		const Bus* fb = FindBus(bus);
 		if (fb) {
-			deque<string_view> stops_v = fb->stops;
-			double coord_length = 0;
-			int real_length = 0;
-			if (stops_v.size() != 0) {
-				all_r.bus_name = bus;
-
-				if (fb->type == "true"s) {
-					all_r.quant_stops = stops_v.size();
-					unordered_set<string_view> us(stops_v.begin(), stops_v.end());
-					all_r.quant_uniq_stops = us.size();
-					for (int i = 0; i < static_cast<int>(stops_v.size()) - 1; i++) {
-						const Stop* one = FindStop(stops_v[i]);
-						const Stop* two = FindStop(stops_v[i + 1]);
-						coord_length += geo::ComputeDistance(one->coordinates, two->coordinates);
-						real_length += GetStopDistance(*one, *two);
-					}
-				}
-				else {
-					all_r.quant_stops = stops_v.size() * 2 - 1;
-					unordered_set<string_view> us(stops_v.begin(), stops_v.end());
-					all_r.quant_uniq_stops = us.size();
-					for (int i = 0; i < static_cast<int>(stops_v.size()) - 1; i++) {
-						const Stop* one = FindStop(stops_v[i]);
-						const Stop* two = FindStop(stops_v[i + 1]);
-						coord_length += geo::ComputeDistance(one->coordinates, two->coordinates);
-						real_length += GetStopDistance(*one, *two);
-					}
-					for (auto it = stops_v.rbegin(); it != stops_v.rend(); ++it) {
-						if (it != stops_v.rbegin()) {
-
-							const Stop* two = FindStop(*it);
-							const Stop* one = FindStop(*(it - 1));
-
-							string st_one_name = one->stop_name;
-							string st_two_name = two->stop_name;
-
-							int new_length = GetStopDistance(*one, *two);
-
-							real_length += new_length;
-						}
-					}
-					coord_length += coord_length;
-				}
-
-				all_r.route_length = real_length;
-				all_r.route_curvature = real_length / coord_length;
-			}
+			all_r.quant_stops = fb->stats.stop_count;
+			all_r.quant_uniq_stops = fb->stats.unique_stop_count;
+			all_r.route_length = fb->stats.route_length;
+			all_r.route_curvature = fb->stats.route_curvature;
 		}
 		else {
-			all_r.bus_name = bus; all_r.quant_stops = 0;
+			all_r.quant_stops = 0;
 		}
 		return all_r;
 	}
 
+	void TransportCatalogue::ComputeBusStats() {
+		for (Bus& bus : buses_) {
+			bus.stats = CalculateBusStats(bus);
+		}
+	}
+
+	BusStats TransportCatalogue::CalculateBusStats(const Bus& bus) const {
+		BusStats stats;
+		const vector<uint32_t>& stops_v = bus.stops;
+		if (stops_v.empty()) {
+			return stats;
+		}
+
+		vector<uint32_t> us(stops_v.begin(), stops_v.end());
+		sort(us.begin(), us.end());
+		stats.unique_stop_count = unique(us.begin(), us.end()) - us.begin();
+
+		double coord_length = 0;
+		int real_length = 0;
+		for (size_t i = 0; i + 1 < stops_v.size(); i++) {
+			coord_length += geo::ComputeDistance(stops_[stops_v[i]].coordinates, stops_[stops_v[i + 1]].coordinates);
+			real_length += bus.distances[i];
+		}
+
+		if (bus.type == "true"s) {
+			stats.stop_count = stops_v.size();
+		}
+		else {
+			stats.stop_count = stops_v.size() * 2 - 1;
+			// обратный путь: расстояния в обратную сторону могут отличаться
+			for (int distance : bus.return_distances) {
+				real_length += distance;
+			}
+			coord_length += coord_length;
+		}
+
+		stats.route_length = real_length;
+		stats.route_curvature = real_length / coord_length;
+		return stats;
+	}
+
 	
 
-	set<string> TransportCatalogue::GetStopInfo(std::string_view s) const {
-		set<string> res;
-		if (stop_info_.count(s)) {
-			return stop_info_.at(s);
+	IdSpan TransportCatalogue::GetStopBuses(uint32_t stop_id) const {
+		if (stop_id + 1 >= stop_bus_offsets_.size()) {
+			return {};
+		}
+		const uint32_t* ids = stop_bus_ids_.data();
+		return { ids + stop_bus_offsets_[stop_id], ids + stop_bus_offsets_[stop_id + 1] };
+	}
+
+	void TransportCatalogue::IndexRoutes() {
+		IndexStopBuses();
+		for (Bus& bus : buses_) {
+			bus.distances = GetSegmentDistances(bus.stops);
+			if (bus.type != "true"s) {
+				bus.return_distances = GetSegmentDistances(vector<uint32_t>(bus.stops.rbegin(), bus.stops.rend()));
+			}
+			else {
+				bus.return_distances.clear();
+			}
+		}
+	}
+
+	vector<int> TransportCatalogue::GetSegmentDistances(const vector<uint32_t>& stops) const {
+		vector<int> distances;
+		for (size_t i = 0; i + 1 < stops.size(); ++i) {
+			distances.push_back(GetStopDistance(stops[i], stops[i + 1]));
+		}
+		return distances;
+	}
+
+	void TransportCatalogue::IndexStopBuses() {
+		// Маршруты обходятся по названиям, тогда список каждой остановки уже упорядочен
+		vector<uint32_t> buses_by_name(buses_.size());
+		for (uint32_t i = 0; i < buses_by_name.size(); ++i) {
+			buses_by_name[i] = i;
+		}
+		sort(buses_by_name.begin(), buses_by_name.end(), [this](uint32_t lhs, uint32_t rhs) {
+			return buses_[lhs].bus_name < buses_[rhs].bus_name;
+		});
+
+		// Маршрут может проходить через остановку несколько раз: запоминаем последний учтённый
+		constexpr uint32_t NO_BUS = numeric_limits<uint32_t>::max();
+		vector<uint32_t> last_bus(stops_.size(), NO_BUS);
+		stop_bus_offsets_.assign(stops_.size() + 1, 0);
+		for (uint32_t bus_id : buses_by_name) {
+			for (uint32_t stop_id : buses_[bus_id].stops) {
+				if (last_bus[stop_id] != bus_id) {
+					last_bus[stop_id] = bus_id;
+					++stop_bus_offsets_[stop_id + 1];
+				}
+			}
+		}
+		for (size_t i = 1; i < stop_bus_offsets_.size(); ++i) {
+			stop_bus_offsets_[i] += stop_bus_offsets_[i - 1];
 		}
-		else { return res; }
 
+		stop_bus_ids_.assign(stop_bus_offsets_.back(), 0);
+		vector<uint32_t> next(stop_bus_offsets_.begin(), stop_bus_offsets_.end() - 1);
+		last_bus.assign(stops_.size(), NO_BUS);
+		for (uint32_t bus_id : buses_by_name) {
+			for (uint32_t stop_id : buses_[bus_id].stops) {
+				if (last_bus[stop_id] != bus_id) {
+					last_bus[stop_id] = bus_id;
+					stop_bus_ids_[next[stop_id]++] = bus_id;
+				}
+			}
+		}
 	}
 
 	void TransportCatalogue::AddStopDistance(StopDistancesDescription distance) {
@@ -127,52 +189,45 @@ namespace transport_catalogue {
 			for (auto el : stop_dist_main) {
 				Stop* another_stop_ptr = stop_name_to_stop_[el.first];
 				int distance = el.second;
-				stops_distance_.emplace(make_pair(main_stop_ptr, another_stop_ptr), distance);
-				stops_distance_time_.emplace(make_pair(main_stop_ptr, another_stop_ptr), distance/( bus_velocity_*1000 / 60));
+				stops_distance_.Insert(main_stop_ptr->id, another_stop_ptr->id, distance);
 			}
 		}
 	}
 
-	int TransportCatalogue::GetStopDistance(const Stop& s11, const Stop& s22) const {
-		const Stop* s1 = &s11;
-		const Stop* s2 = &s22;
-		auto it = stops_distance_.find(make_pair(s1, s2));
-		auto it2 = stops_distance_.find(make_pair(s2, s1));
+	int TransportCatalogue::GetStopDistance(const Stop& s1, const Stop& s2) const {
+		return GetStopDistance(s1.id, s2.id);
+	}
 
-		if (it != stops_distance_.end()) {
-			return stops_distance_.at(make_pair(s1, s2));
+	int TransportCatalogue::GetStopDistance(uint32_t from_id, uint32_t to_id) const {
+		if (const int* distance = stops_distance_.Find(from_id, to_id)) {
+			return *distance;
 		}
-		else if (it2 != stops_distance_.end()) {
-			return stops_distance_.at(make_pair(s2, s1));
+		if (const int* distance = stops_distance_.Find(to_id, from_id)) {
+			return *distance;
 		}
-		else { return 0; }
+		return 0;
 	}
 
 	const std::deque<Bus>& TransportCatalogue::GetBuses() const { return buses_; }
 	const std::deque<Stop>& TransportCatalogue::GetStops() const { return stops_; }
 
 	void TransportCatalogue::AddRouteSettings(const domain::RouteSettings route_settings) {
-		bus_wait_time_ = route_settings.bus_wait_time;
-		bus_velocity_ = route_settings.bus_velocity;
+		route_settings_ = route_settings;
 	}
 
-	double TransportCatalogue::GetWaitTime() { return bus_wait_time_;  };
+	double TransportCatalogue::GetWaitTime() const { return route_settings_.bus_wait_time;  };
 
-	size_t TransportCatalogue::GetStopsQuantity() {
+	size_t TransportCatalogue::GetStopsQuantity() const {
 		return stop_name_to_stop_.size();
 	}
 	
-	std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, double, detail::PairOfStopPointerUsingString> TransportCatalogue::GetstopsDistanceTime() {
-		return stops_distance_time_;
-	};
-
-	double TransportCatalogue::GetVelocity() { return bus_velocity_; }
+	double TransportCatalogue::GetVelocity() const { return route_settings_.bus_velocity; }
 
 	void TransportCatalogue::AddSerializePathToFile(const std::string& serialize_file_path) {
 		serialize_file_path_ = serialize_file_path;
 	}
 
-	const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, detail::PairOfStopPointerUsingString>& TransportCatalogue::GetStopDistances() const {
+	const StopDistanceTable& TransportCatalogue::GetStopDistances() const {
 		return stops_distance_;
 	}
 
@@ -181,8 +236,7 @@ namespace transport_catalogue {
 			const Stop* startStop = distance.start;
 			const Stop* endStop = distance.end;
 			int distanceValue = distance.distance;
-			stops_distance_.emplace(std::make_pair(startStop, endStop), distanceValue);
-			stops_distance_time_.emplace(std::make_pair(startStop, endStop), distanceValue / (bus_velocity_ * 1000 / 60));
+			stops_distance_.Insert(startStop->id, endStop->id, distanceValue);
 		}
 	}
 
@@ -193,10 +247,12 @@ namespace transport_catalogue {
 
 
     domain::RouteSettings TransportCatalogue::GetRouteSettings() const{
-        RouteSettings rs;
-        rs.bus_velocity = bus_velocity_;
-        rs.bus_wait_time = bus_wait_time_;
-        return rs;
+        return route_settings_;
     }
 
+	std::shared_ptr<const TransportCatalogue> TransportCatalogue::Freeze() && {
+		// Перемещение deque не переносит элементы, так что указатели и string_view индексов остаются верными
+		return std::make_shared<const TransportCatalogue>(std::move(*this));
+	}
+
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "domain.h"
+#include "stop_distance_table.h"
 
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include "geo.h"
@@ -17,6 +20,21 @@ namespace transport_catalogue {
 
 		std::string from;
 		std::string to;
+
+		// RouteMatrix: остановки отправления и назначения, нужны ли маршруты целиком
+		std::vector<std::string> origins;
+		std::vector<std::string> destinations;
+		bool itineraries = false;
+
+		// Isochrone: остановка отправления в from и время в пути в минутах
+		double max_time = 0.0;
+
+		// Route, RouteMatrix, Isochrone: скорость и время ожидания вместо настроек базы
+		std::optional<double> bus_velocity;
+		std::optional<double> bus_wait_time;
+
+		// Запрос отклонён при разборе: в ответе только request_id и это сообщение
+		std::optional<std::string> error_message;
 	};
 
 	struct StopComparer {
@@ -32,79 +50,95 @@ namespace transport_catalogue {
 	};
 
 
-	namespace detail {
-		struct PairOfStopPointerUsingString {
-			std::size_t operator()(const std::pair<const  domain::Stop*, const  domain::Stop*>& p) const {
-				const std::size_t constantal = 31;
-				std::size_t hash_value_one = 0;
-				std::size_t hash_value_two = 0;
-				std::size_t p_pow = 1;
-				for (char c : p.first->stop_name) {
-					hash_value_one = (hash_value_one + (c - 'a' + 1) * p_pow) % std::size_t(-1);
-					p_pow = (p_pow * constantal) % std::size_t(-1);
-				}
-
-				for (char c : p.second->stop_name) {
-					hash_value_one = (hash_value_two + (c - 'a' + 1) * p_pow) % std::size_t(-1);
-					p_pow = (p_pow * constantal) % std::size_t(-1);
-				}
-
-				return hash_value_one + hash_value_two * constantal;
-			}
-		};
-	}
-
-
+	// Справочник заполняется в одном потоке. После Freeze остаётся снимок, у которого доступны
+	// только константные методы: они ничего не изменяют и не кэшируют, поэтому снимок можно
+	// читать из любого числа потоков без блокировок
 	class TransportCatalogue {
 	public:
+		// Названия остановок маршрута переводятся в индексы один раз, при добавлении
 		void AddBus(const domain::BusDescription& bus);
+		// Маршрут с остановками, уже заданными индексами; id назначается здесь
+		void AddBus(domain::Bus bus);
 		void AddStop(domain::Stop stop);
 		const domain::Bus* FindBus(std::string_view bus) const;
 		virtual const domain::Stop* FindStop(std::string_view stop) const;
+		// Ответ из сохранённых характеристик маршрута, без пересчёта
 		domain::AllBusInfoBusResponse GetAllBusInfo(std::string_view bus) const;
-		std::set<std::string> GetStopInfo(std::string_view s) const;
+		// Считает BusStats всех маршрутов; вызывается после IndexRoutes
+		void ComputeBusStats();
+		// Индексы маршрутов через остановку, по возрастанию названий маршрутов.
+		// Диапазон действителен, пока справочник не изменится
+		domain::IdSpan GetStopBuses(uint32_t stop_id) const;
+		// Строит индекс остановка -> маршруты и расстояния участков маршрутов;
+		// вызывается, когда добавлены все маршруты и расстояния
+		void IndexRoutes();
 		void AddStopDistance(domain::StopDistancesDescription distance);
 		int GetStopDistance(const domain::Stop& s1, const domain::Stop& s2)  const;
+		// Расстояние from -> to, если оно не задано - to -> from, иначе 0
+		int GetStopDistance(uint32_t from_id, uint32_t to_id) const;
 
 		const std::deque<domain::Bus>& GetBuses() const;
 		const std::deque<domain::Stop>& GetStops() const ;
 
 		// добавлено на 13 спринт
 		void AddRouteSettings(const domain::RouteSettings route_settings);
-		double GetWaitTime();
-		std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, double, detail::PairOfStopPointerUsingString> GetstopsDistanceTime();
+		double GetWaitTime() const;
 		
-		double GetVelocity();
-		size_t GetStopsQuantity();
-
-		std::string GetStopNameByVertexId(size_t vertex_id);
-		size_t GetStopVertexIdByName(std::string_view stop_name);
-		bool CheckExistenceOfStopByName(std::string stop_name);
-		std::set<domain::Stop*, StopPointerComparer> GetStopSet();
+		double GetVelocity() const;
+		size_t GetStopsQuantity() const;
 
 		// Добавлено 15 спринт 
 		void AddSerializePathToFile(const std::string& serialize_file_path);
 
-		const std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, detail::PairOfStopPointerUsingString>& GetStopDistances() const;
+		const StopDistanceTable& GetStopDistances() const;
 
 		void AddDistanceFromSerializer(const std::vector<domain::Distance>& distances);
 		std::string GetSerializerFilePath() const;
         domain::RouteSettings GetRouteSettings() const;
 
+		// Неизменяемый снимок заполненного справочника (после IndexRoutes). Данные переносятся,
+		// а не копируются: остановки и маршруты остаются на своих адресах
+		std::shared_ptr<const TransportCatalogue> Freeze() &&;
+
 	private:
-		double bus_wait_time_ = 6;  // добавлено на 13 спринт
-		double bus_velocity_ = 40; // добавлено на 13 спринт
+		domain::BusStats CalculateBusStats(const domain::Bus& bus) const;
+		void IndexStopBuses();
+		std::vector<int> GetSegmentDistances(const std::vector<uint32_t>& stops) const;
+
+		domain::RouteSettings route_settings_;  // добавлено на 13 спринт
 		std::deque<domain::Bus> buses_;
 		std::deque<domain::Stop> stops_;
 		
 		std::unordered_map<std::string_view, domain::Stop*> stop_name_to_stop_;
 		std::unordered_map<std::string_view, domain::Bus*> bus_name_to_bus_;
-		std::unordered_map<std::string_view, std::set<std::string>> stop_info_;
-		std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, int, detail::PairOfStopPointerUsingString> stops_distance_;
-		std::unordered_map<std::pair<const domain::Stop*, const domain::Stop*>, double, detail::PairOfStopPointerUsingString> stops_distance_time_;
+		// Индекс в формате CSR: маршруты остановки i - stop_bus_ids_[stop_bus_offsets_[i], stop_bus_offsets_[i + 1])
+		std::vector<uint32_t> stop_bus_offsets_;
+		std::vector<uint32_t> stop_bus_ids_;
+		StopDistanceTable stops_distance_;
 		
 		// добавоено на 15 спринт 
 		std::string serialize_file_path_;
 
 	};
-}
\ No newline at end of file
+
+	// Текущий снимок справочника, общий для потоков-обработчиков запросов. Store атомарно
+	// подменяет снимок: читатель, уже получивший снимок через Load, продолжает работать
+	// со старым - shared_ptr держит его, пока последний читатель не отпустит
+	class FrozenCatalogueHolder {
+	public:
+		explicit FrozenCatalogueHolder(std::shared_ptr<const TransportCatalogue> catalogue = nullptr)
+			: catalogue_(std::move(catalogue)) {
+		}
+
+		std::shared_ptr<const TransportCatalogue> Load() const {
+			return std::atomic_load(&catalogue_);
+		}
+
+		void Store(std::shared_ptr<const TransportCatalogue> catalogue) {
+			std::atomic_store(&catalogue_, std::move(catalogue));
+		}
+
+	private:
+		std::shared_ptr<const TransportCatalogue> catalogue_;
+	};
+}
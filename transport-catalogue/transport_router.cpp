@@ -1,37 +1,215 @@
 #include "transport_router.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 #include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <variant>
 
 namespace graph {
 
 
-		ActivityProcessor::ActivityProcessor(transport_catalogue::TransportCatalogue& tc)
+		ActivityProcessor::ActivityProcessor(const transport_catalogue::TransportCatalogue& tc)
 			: tc(tc) {
-			graph_ = DirectedWeightedGraph<double>(2 * tc.GetStopsQuantity());
+			if (tc.GetRouteSettings().router_type == domain::RouterType::RAPTOR) {
+				CreateRouter();
+				return;
+			}
 			AddKnots();
+			graph_.Freeze();
+			CreateRouter();
+		}
 
-			router_ = std::unique_ptr<graph::Router<double>>(new graph::Router<double>(graph_));
+		ActivityProcessor::ActivityProcessor(const transport_catalogue::TransportCatalogue& tc, RoutingData routing_data)
+			: tc(tc)
+			, graph_(std::move(routing_data.graph))
+			, stop_to_vertex_(std::move(routing_data.stop_to_vertex)) {
+			if (auto* table = std::get_if<Router<RouteWeight>::RoutesInternalData>(&routing_data.routes_table)) {
+				router_ = std::make_unique<graph::Router<RouteWeight>>(graph_, std::move(*table));
+			}
+			else if (auto* table = std::get_if<Router<RouteWeight, float>::RoutesInternalData>(&routing_data.routes_table)) {
+				router_ = std::make_unique<graph::Router<RouteWeight, float>>(graph_, std::move(*table));
+			}
+			else if (auto* hierarchy = std::get_if<ContractionHierarchy<RouteWeight>::Hierarchy>(&routing_data.routes_table)) {
+				router_ = std::make_unique<graph::ContractionHierarchy<RouteWeight>>(graph_, std::move(*hierarchy));
+			}
+			else if (auto* landmarks = std::get_if<LandmarkTables<RouteWeight>>(&routing_data.routes_table)) {
+				CreateLandmarkRouter(std::move(*landmarks));
+			}
+			else {
+				CreateRouter();
+			}
+		}
+
+		void ActivityProcessor::CreateRouter() {
+			const domain::RouteSettings route_settings = tc.GetRouteSettings();
+			if (route_settings.router_type == domain::RouterType::PRECOMPUTED && route_settings.router_float_weights) {
+				router_ = std::make_unique<graph::Router<RouteWeight, float>>(graph_, route_settings.router_threads);
+			}
+			else if (route_settings.router_type == domain::RouterType::PRECOMPUTED) {
+				router_ = std::make_unique<graph::Router<RouteWeight>>(graph_, route_settings.router_threads);
+			}
+			else if (route_settings.router_type == domain::RouterType::RAPTOR) {
+				raptor_router_ = std::make_unique<graph::RaptorRouter>(tc);
+			}
+			else if (route_settings.router_type == domain::RouterType::CONTRACTION_HIERARCHIES) {
+				router_ = std::make_unique<graph::ContractionHierarchy<RouteWeight>>(graph_);
+			}
+			else if (route_settings.router_type == domain::RouterType::ASTAR) {
+				router_ = MakeDijkstraRouter(MakeGeoPotential());
+			}
+			else if (route_settings.router_type == domain::RouterType::BIDIRECTIONAL_DIJKSTRA) {
+				router_ = std::make_unique<graph::BidirectionalDijkstraRouter<RouteWeight>>(graph_);
+			}
+			else if (route_settings.router_type == domain::RouterType::ALT) {
+				// Опорные вершины выбираются среди вершин остановок, порядок фиксирован для воспроизводимости
+				std::vector<VertexId> candidates;
+				candidates.reserve(stop_to_vertex_.size());
+				for (const auto& [stop_name, vertex] : stop_to_vertex_) {
+					candidates.push_back(vertex);
+				}
+				std::sort(candidates.begin(), candidates.end());
+				CreateLandmarkRouter(LandmarkTables<RouteWeight>::Compute(graph_, candidates, route_settings.router_landmarks));
+			}
+			else {
+				router_ = MakeDijkstraRouter({});
+			}
+		}
+
+		void ActivityProcessor::CreateLandmarkRouter(LandmarkTables<RouteWeight> landmarks) {
+			landmarks_ = std::move(landmarks);
+			const LandmarkTables<RouteWeight>* tables = &*landmarks_;
+			router_ = MakeDijkstraRouter(
+				[tables](VertexId vertex, VertexId target) { return tables->GetPotential(vertex, target); });
+		}
+
+		std::unique_ptr<RouterBase<RouteWeight>> ActivityProcessor::MakeDijkstraRouter(DijkstraRouter<RouteWeight>::Potential potential) {
+			const domain::RouteSettings& route_settings = tc.GetRouteSettings();
+			// Кэш деревьев нужен только поиску без оценки: A* строит не всё дерево
+			ShortestPathTreeCache<RouteWeight>* tree_cache = nullptr;
+			if (!potential && route_settings.router_cache_bytes > 0) {
+				tree_cache_ = std::make_unique<ShortestPathTreeCache<RouteWeight>>(route_settings.router_cache_bytes);
+				tree_cache = tree_cache_.get();
+			}
+
+			if (route_settings.router_queue == domain::QueueType::RADIX_HEAP) {
+				return std::make_unique<graph::DijkstraRouter<RouteWeight, RadixHeap>>(graph_, std::move(potential), tree_cache);
+			}
+			return std::make_unique<graph::DijkstraRouter<RouteWeight>>(graph_, std::move(potential), tree_cache);
+		}
+
+		DijkstraRouter<RouteWeight>::Potential ActivityProcessor::MakeGeoPotential() const {
+			const std::deque<domain::Stop>& stops = tc.GetStops();
+
+			// Координаты вершин: вершины остановок из stop_to_vertex_, концы рёбер ожидания -
+			// остановка ребра, начало ребра высадки (LINE_SEGMENTS) - остановка его конца
+			std::vector<std::optional<geo::Coordinates>> coordinates(graph_.GetVertexCount());
+			for (const auto& [stop_name, vertex] : stop_to_vertex_) {
+				coordinates[vertex] = tc.FindStop(stop_name)->coordinates;
+			}
+			for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+				const auto& edge = graph_.GetEdge(edge_id);
+				if (edge.stop_count == 0 && edge.name_id != NO_ACTIVITY_ID) {
+					coordinates[edge.from] = stops[edge.name_id].coordinates;
+					coordinates[edge.to] = stops[edge.name_id].coordinates;
+				}
+			}
+			for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+				const auto& edge = graph_.GetEdge(edge_id);
+				if (edge.stop_count == 0 && edge.name_id == NO_ACTIVITY_ID) {
+					coordinates[edge.from] = coordinates[edge.to];
+				}
+			}
+
+			// Дорожное расстояние может оказаться короче прямой, поэтому вместо 1 / bus_velocity
+			// берётся наименьшее время на метр прямой по всем рёбрам поездки: с ним оценка
+			// не превышает вес ни одного ребра и остаётся согласованной
+			double minutes_per_meter = 1.0 / (tc.GetVelocity() * 1000 / 60);
+			for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+				const auto& edge = graph_.GetEdge(edge_id);
+				if (edge.stop_count == 0 || !coordinates[edge.from] || !coordinates[edge.to]) {
+					continue;
+				}
+				const double distance = geo::ComputeDistance(*coordinates[edge.from], *coordinates[edge.to]);
+				if (distance > 0) {
+					minutes_per_meter = std::min(minutes_per_meter, ToMinutes(edge.weight) / distance);
+				}
+			}
+
+			return [coordinates = std::move(coordinates), minutes_per_meter](VertexId vertex, VertexId target) {
+				if (!coordinates[vertex] || !coordinates[target]) {
+					return RouteWeight{};
+				}
+				const double minutes = geo::ComputeDistance(*coordinates[vertex], *coordinates[target]) * minutes_per_meter;
+				// Округление вниз сохраняет согласованность оценки при целых весах
+				if constexpr (std::is_integral_v<RouteWeight>) {
+					return static_cast<RouteWeight>(std::floor(minutes * ROUTE_WEIGHT_PER_MINUTE));
+				}
+				else {
+					return minutes;
+				}
+			};
 		}
 
 		void ActivityProcessor::AddKnots() {
 			const std::deque<domain::Bus>& buses_ = tc.GetBuses();
 
+			// Рёбра хранят индексы остановок и автобусов, названия подставляются только в ответе
+			if (tc.GetRouteSettings().graph_model == domain::GraphModel::LINE_SEGMENTS) {
+				AddLineKnots();
+				return;
+			}
+
+			// Остановке id соответствуют вершина ожидания 2 * id и вершина посадки 2 * id + 1
+			graph_ = DirectedWeightedGraph<RouteWeight>(2 * tc.GetStops().size());
+
+			// На каждом направлении из n остановок: n - 1 рёбер ожидания и n * (n - 1) / 2 рёбер поездки
+			size_t edge_count = 0;
 			for (const domain::Bus& bus : buses_) {
-				std::string type = bus.type;
-				std::deque<std::string_view> stops = bus.stops;
+				const size_t n = bus.stops.size();
+				const size_t direction_edges = n > 0 ? (n - 1) + n * (n - 1) / 2 : 0;
+				edge_count += bus.type == "true" ? direction_edges : 2 * direction_edges;
+			}
+			graph_.ReserveEdges(edge_count);
 
-				if (type == "true") {
-					AddStopsOneDirection(stops, bus.bus_name);
+			for (const domain::Bus& bus : buses_) {
+				if (bus.type == "true") {
+					AddStopsOneDirection(bus.stops, bus.distances, bus.id);
 				}
 				else {
-					AddStopsNonRoundTrip(stops, bus.bus_name);
+					AddStopsNonRoundTrip(bus);
 				}
+			}
+			IndexStopVertices(2);
+		}
 
+		void ActivityProcessor::IndexStopVertices(size_t vertices_per_stop) {
+			// Маршрут из одной остановки рёбер не добавляет
+			std::vector<bool> is_route_stop(tc.GetStops().size(), false);
+			for (const domain::Bus& bus : tc.GetBuses()) {
+				if (bus.stops.size() < 2) {
+					continue;
+				}
+				for (const uint32_t stop_id : bus.stops) {
+					is_route_stop[stop_id] = true;
+				}
+			}
+			for (const domain::Stop& stop : tc.GetStops()) {
+				if (is_route_stop[stop.id]) {
+					stop_to_vertex_.emplace(stop.stop_name, stop.id * vertices_per_stop);
+				}
 			}
 		}
 
-		std::optional<DestinatioInfo> ActivityProcessor::GetRouteAndBuses(std::string_view stop_name_from, std::string_view stop_name_to) {
-			DestinatioInfo dest_info;
-			std::vector<std::variant<graph::BusActivity, graph::WaitingActivity>> final_route;
+		std::optional<DestinatioInfo> ActivityProcessor::GetRouteAndBuses(std::string_view stop_name_from, std::string_view stop_name_to,
+			const std::optional<domain::RouteWeightParameters>& parameters) {
+			const domain::RouteWeightParameters base_parameters = tc.GetRouteSettings().GetWeightParameters();
+			const domain::RouteWeightParameters weight_parameters = parameters.value_or(base_parameters);
+			if (raptor_router_) {
+				return GetRaptorRouteAndBuses(stop_name_from, stop_name_to, weight_parameters);
+			}
+
 			size_t from;
 			size_t to;
 			if (!ChekExistValue(stop_name_from) || !ChekExistValue(stop_name_to)) {
@@ -41,51 +219,244 @@ namespace graph {
 			from = stop_to_vertex_.find(stop_name_from)->second;
 			to = stop_to_vertex_.find(stop_name_to)->second;
 
-			std::optional<typename graph::Router<double>::RouteInfo> route_info = router_->BuildRoute(from, to);
+			std::optional<typename graph::RouterBase<RouteWeight>::RouteInfo> route_info = weight_parameters == base_parameters
+				? router_->BuildRoute(from, to)
+				: GetTreeRouter(weight_parameters).BuildRoute(from, to);
+
+			if (route_info.has_value()) {
+				return MakeDestinationInfo(route_info.value(), weight_parameters);
+			}
+			else {
+				return std::nullopt;
+			}
+
+		}
 
-			double wait_time = tc.GetWaitTime();
+		DestinatioInfo ActivityProcessor::MakeDestinationInfo(const RouterBase<RouteWeight>::RouteInfo& route_info,
+			const domain::RouteWeightParameters& parameters) const {
+			DestinatioInfo dest_info;
+			std::vector<std::variant<graph::BusActivity, graph::WaitingActivity>> final_route;
+			double wait_time = parameters.bus_wait_time;
+
+			bool riding = false; // предыдущее ребро - поездка, следующая поездка продолжает её (LINE_SEGMENTS)
+			for (auto it = route_info.edges.begin(); it != route_info.edges.end(); ++it) {
+				auto EdgId = *it;
+				const auto& Edge = graph_.GetEdge(EdgId);
+				if (Edge.stop_count == 0 && Edge.name_id == NO_ACTIVITY_ID) {
+					riding = false;
+				}
+				else if (Edge.stop_count == 0) {
+					WaitingActivity wa;
+					wa.time = wait_time;
+					wa.stop_name_from = tc.GetStops()[Edge.name_id].stop_name;
 
-			std::set<std::string> actual_buses;
-			std::set<std::string> buses_for_route_first_stop;
-			std::set<std::string> buses_for_route_second_stop;
+					final_route.push_back(wa);
+					riding = false;
+				}
+				else if (riding) {
+					BusActivity& ba = std::get<BusActivity>(final_route.back());
+					ba.time += ToMinutes(ComputeEdgeWeight(Edge, parameters));
+					ba.span_count += Edge.stop_count;
+				}
+				else {
+					BusActivity ba;
+					ba.bus_name = tc.GetBuses()[Edge.name_id].bus_name;
+					ba.time = ToMinutes(ComputeEdgeWeight(Edge, parameters));
+					ba.span_count = Edge.stop_count;
+					final_route.push_back(ba);
+					riding = true;
+				}
 
-			if (route_info.has_value()) {
-				const auto& route_info_value = route_info.value();
+			}
 
-				for (auto it = route_info_value.edges.begin(); it != route_info_value.edges.end(); ++it) {
-					auto EdgId = *it;
-					auto Edge = graph_.GetEdge(EdgId);
-					if (Edge.stop_count == 0) {
-						WaitingActivity wa;
-						wa.time = wait_time;
-						wa.stop_name_from = Edge.name;
+			for (const auto& activity : final_route) {
+				dest_info.all_time += std::visit([](const auto& act) { return act.time; }, activity);
+			}
+			dest_info.route = std::move(final_route);
 
-						final_route.push_back(wa);
-						dest_info.all_time += wait_time;
+			return dest_info;
+		}
 
+		std::vector<std::vector<std::optional<DestinatioInfo>>> ActivityProcessor::GetRouteMatrix(const std::vector<std::string>& origins,
+			const std::vector<std::string>& destinations, bool with_itineraries,
+			const std::optional<domain::RouteWeightParameters>& parameters) {
+			std::vector<std::vector<std::optional<DestinatioInfo>>> matrix(origins.size(),
+				std::vector<std::optional<DestinatioInfo>>(destinations.size()));
+
+			const domain::RouteSettings& route_settings = tc.GetRouteSettings();
+			const domain::RouteWeightParameters weight_parameters = parameters.value_or(route_settings.GetWeightParameters());
+			const bool base_weights = weight_parameters == route_settings.GetWeightParameters();
+
+			// Таблица PRECOMPUTED отвечает на пару за O(1), а RAPTOR работает без графа
+			if (raptor_router_ || (route_settings.router_type == domain::RouterType::PRECOMPUTED && base_weights)) {
+				for (size_t i = 0; i < origins.size(); ++i) {
+					for (size_t j = 0; j < destinations.size(); ++j) {
+						matrix[i][j] = GetRouteAndBuses(origins[i], destinations[j], weight_parameters);
+						if (matrix[i][j] && !with_itineraries) {
+							matrix[i][j]->route.clear();
+						}
 					}
+				}
+				return matrix;
+			}
 
-					else {
-						BusActivity ba;
-						ba.bus_name = Edge.name;
-						ba.time = Edge.weight;
-						ba.span_count = Edge.stop_count;
-						final_route.push_back(ba);
-						dest_info.all_time += Edge.weight;
+			// Кэш деревьев хранит деревья для весов базы
+			ShortestPathTreeCache<RouteWeight>* tree_cache = base_weights ? tree_cache_.get() : nullptr;
+			const DijkstraRouter<RouteWeight>& tree_router = GetTreeRouter(weight_parameters);
+			for (size_t i = 0; i < origins.size(); ++i) {
+				const auto from = GetValueByKey(origins[i]);
+				if (!from) {
+					continue;
+				}
 
+				auto tree = tree_cache ? tree_cache->Find(*from) : nullptr;
+				if (!tree) {
+					tree = tree_router.BuildTree(*from);
+					if (tree_cache) {
+						tree_cache->Insert(*from, tree);
 					}
+				}
 
+				for (size_t j = 0; j < destinations.size(); ++j) {
+					const auto to = GetValueByKey(destinations[j]);
+					if (!to) {
+						continue;
+					}
+					const auto route_info = tree_router.BuildRouteFromTree(*tree, *to);
+					if (!route_info) {
+						continue;
+					}
+					if (with_itineraries) {
+						matrix[i][j] = MakeDestinationInfo(*route_info, weight_parameters);
+					}
+					else {
+						matrix[i][j] = DestinatioInfo{ {}, ToMinutes(route_info->weight) };
+					}
 				}
-				dest_info.route = final_route;
+			}
+			return matrix;
+		}
 
-				return dest_info;
+
+		std::optional<std::vector<ReachableStop>> ActivityProcessor::GetIsochrone(std::string_view stop_name_from, double max_time,
+			const std::optional<domain::RouteWeightParameters>& parameters) {
+			// Отрицательное время в фиксированной точке превратилось бы в огромный беззнаковый вес
+			if (!(max_time >= 0)) {
+				throw std::invalid_argument("Isochrone max_time should be non-negative");
+			}
+			const domain::RouteWeightParameters weight_parameters = parameters.value_or(tc.GetRouteSettings().GetWeightParameters());
+			std::vector<ReachableStop> reachable_stops;
+
+			if (raptor_router_) {
+				const auto reachable = raptor_router_->BuildReachable(stop_name_from, max_time, weight_parameters);
+				if (!reachable) {
+					return std::nullopt;
+				}
+				const std::deque<domain::Stop>& stops = tc.GetStops();
+				for (const auto& [stop_id, time] : *reachable) {
+					reachable_stops.push_back({ stops[stop_id].stop_name, time });
+				}
 			}
 			else {
+				const auto from = GetValueByKey(stop_name_from);
+				if (!from) {
+					return std::nullopt;
+				}
+				const DijkstraRouter<RouteWeight>& tree_router = GetTreeRouter(weight_parameters);
+				if (vertex_to_stop_.empty()) {
+					vertex_to_stop_.resize(graph_.GetVertexCount());
+					for (const auto& [stop_name, vertex] : stop_to_vertex_) {
+						vertex_to_stop_[vertex] = stop_name;
+					}
+				}
+
+				// Вершины позиций на маршрутах и концы рёбер ожидания в ответ не попадают
+				for (const auto& [vertex, weight] : tree_router.BuildReachable(*from, ToRouteWeight(max_time))) {
+					if (vertex_to_stop_[vertex]) {
+						reachable_stops.push_back({ *vertex_to_stop_[vertex], ToMinutes(weight) });
+					}
+				}
+			}
+
+			std::sort(reachable_stops.begin(), reachable_stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+				return std::tie(lhs.time, lhs.stop_name) < std::tie(rhs.time, rhs.stop_name);
+			});
+			return reachable_stops;
+		}
+
+		const DijkstraRouter<RouteWeight>& ActivityProcessor::GetTreeRouter() {
+			if (!tree_router_) {
+				tree_router_ = std::make_unique<DijkstraRouter<RouteWeight>>(graph_);
+			}
+			return *tree_router_;
+		}
+
+		const DijkstraRouter<RouteWeight>& ActivityProcessor::GetTreeRouter(const domain::RouteWeightParameters& parameters) {
+			if (parameters == tc.GetRouteSettings().GetWeightParameters()) {
+				return GetTreeRouter();
+			}
+			if (!parametric_router_ || parametric_router_->parameters != parameters) {
+				std::vector<RouteWeight> edge_weights;
+				edge_weights.reserve(graph_.GetEdgeCount());
+				for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+					edge_weights.push_back(ComputeEdgeWeight(graph_.GetEdge(edge_id), parameters));
+				}
+				parametric_router_ = ParametricRouter{ parameters,
+					std::make_unique<DijkstraRouter<RouteWeight>>(graph_, DijkstraRouter<RouteWeight>::Potential{}, nullptr, std::move(edge_weights)) };
+			}
+			return *parametric_router_->router;
+		}
+
+		void ActivityProcessor::AddWeightedEdge(Edge<RouteWeight> edge) {
+			edge.weight = ComputeEdgeWeight(edge, tc.GetRouteSettings().GetWeightParameters());
+			graph_.AddEdge(edge);
+		}
+
+		std::optional<DestinatioInfo> ActivityProcessor::GetRaptorRouteAndBuses(std::string_view stop_name_from, std::string_view stop_name_to,
+			const domain::RouteWeightParameters& parameters) {
+			std::optional<std::vector<RaptorLeg>> legs = raptor_router_->BuildRoute(stop_name_from, stop_name_to, parameters);
+			if (!legs) {
 				return std::nullopt;
 			}
 
+			DestinatioInfo dest_info;
+			for (const RaptorLeg& leg : *legs) {
+				WaitingActivity wa;
+				wa.time = parameters.bus_wait_time;
+				wa.stop_name_from = tc.GetStops()[leg.board_stop].stop_name;
+				dest_info.route.push_back(wa);
+				dest_info.all_time += wa.time;
+
+				BusActivity ba;
+				ba.bus_name = tc.GetBuses()[leg.bus_id].bus_name;
+				ba.time = leg.ride_time;
+				ba.span_count = leg.span_count;
+				dest_info.route.push_back(ba);
+				dest_info.all_time += ba.time;
+			}
+
+			return dest_info;
 		}
 
+		const DirectedWeightedGraph<RouteWeight>& ActivityProcessor::GetGraph() const {
+			return graph_;
+		}
+
+		const std::unordered_map<std::string_view, size_t>& ActivityProcessor::GetStopToVertex() const {
+			return stop_to_vertex_;
+		}
+
+		const RouterBase<RouteWeight>* ActivityProcessor::GetRouter() const {
+			return router_.get();
+		}
+
+		const LandmarkTables<RouteWeight>* ActivityProcessor::GetLandmarks() const {
+			return landmarks_ ? &*landmarks_ : nullptr;
+		}
+
+		const ShortestPathTreeCacheStats* ActivityProcessor::GetTreeCacheStats() const {
+			return tree_cache_ ? &tree_cache_->GetStats() : nullptr;
+		}
 
 		std::optional<size_t> ActivityProcessor::GetValueByKey(std::string_view key) {
 			auto it = stop_to_vertex_.find(key);
@@ -107,91 +478,75 @@ namespace graph {
 			}
 		}
 
-		void ActivityProcessor::AddStopsOneDirection(const std::deque<std::string_view>& stops, const std::string& bus_name) {
+		void ActivityProcessor::AddStopsOneDirection(const std::vector<uint32_t>& stops, const std::vector<int>& distances,
+			uint32_t bus_id) {
 
-			for (auto it = stops.begin(); std::next(it) != stops.end(); ++it) {
-				double sum_time = 0; // накапливаемое время движения по ходу маршрута с каждой следующей остановкой сюда 
-				size_t num_vertex_1_wait;
-				size_t num_vertex_next_wait;
-
-				if (ChekExistValue(*it)) {
-					auto indx = stop_to_vertex_.find(*it);
-					num_vertex_1_wait = indx->second;
-				}
-				else {
-					num_vertex_1_wait = stop_to_vertex_.size() * 2;
-					stop_to_vertex_.insert({ *it , num_vertex_1_wait });
-
-				}
+			for (size_t i = 0; i + 1 < stops.size(); ++i) {
+				int sum_distance = 0; // накапливаемое расстояние по ходу маршрута с каждой следующей остановкой сюда 
+				const size_t num_vertex_1_wait = 2 * stops[i];
+				const size_t num_vertex1_go = num_vertex_1_wait + 1;
 
-				if (ChekExistValue(*std::next(it))) {
-					auto indx = stop_to_vertex_.find(*std::next(it));
-					num_vertex_next_wait = indx->second;
-				}
-				else {
-					num_vertex_next_wait = stop_to_vertex_.size() * 2;
-					stop_to_vertex_.insert({ *std::next(it), num_vertex_next_wait });
+				AddWeightedEdge({ num_vertex_1_wait, num_vertex1_go, RouteWeight{}, stops[i], 0, 0, 1 });  // добавляю ребро зеркало для первой остановки 
 
+				for (size_t j = i + 1; j < stops.size(); ++j) {
+					sum_distance += distances[j - 1];
+					const int span_count = static_cast<int>(j - i);
+					AddWeightedEdge({ num_vertex1_go, 2 * static_cast<size_t>(stops[j]), RouteWeight{}, bus_id, span_count, sum_distance, 0 });
 				}
+			}
 
+		}
 
 
-				size_t num_vertex1_go = num_vertex_1_wait + 1;
-
-
-				const domain::Stop* stop_1 = tc.FindStop(*it);
-				const domain::Stop* stop_1_next = tc.FindStop(*std::next(it));
-				int distance_inner = tc.GetStopDistance(*stop_1, *stop_1_next); // расстояние от остановки 
-				double time_inner = distance_inner / (tc.GetVelocity() * 1000 / 60) + sum_time;
-
-				Edge<double>* edge_mirror = new Edge<double>{ num_vertex_1_wait, num_vertex1_go, tc.GetWaitTime() , std::string(*it), 0 };  // добавляю ребро зеркало для первой остановки 
-				Edge<double>* edge_go_wait = new Edge<double>{ num_vertex1_go, num_vertex_next_wait, time_inner, bus_name, 1 };  // добавляю ребро зеркало для первой остановки 
-
-				graph_.AddEdge(*edge_mirror);
-
-				graph_.AddEdge(*edge_go_wait);
-
-				sum_time = time_inner;
-
-				for (auto it_inner = std::next(it); std::next(it_inner) != stops.end(); ++it_inner) {
-
-					size_t num_vertex_inner_next_wait;
-					if (ChekExistValue(*std::next(it_inner))) {
-						auto indx = stop_to_vertex_.find(*std::next(it_inner));
-						num_vertex_inner_next_wait = indx->second;
-					}
-					else {
-						num_vertex_inner_next_wait = stop_to_vertex_.size() * 2;
-						stop_to_vertex_.insert({ *std::next(it_inner), num_vertex_inner_next_wait });
-
-					}
-
-
-
-					const domain::Stop* stop_inner = tc.FindStop(*it_inner);
-					const domain::Stop* stop_inner_next = tc.FindStop(*(std::next(it_inner)));
-					int distance_1_2 = tc.GetStopDistance(*stop_inner, *stop_inner_next); // расстояние от остановки 
-
+		void ActivityProcessor::AddLineKnots() {
+			const std::deque<domain::Bus>& buses_ = tc.GetBuses();
 
-					double time_min_1_2 = distance_1_2 / (tc.GetVelocity() * 1000 / 60) + sum_time; // увиличиваю время на то что уже было накоплено пока ехал до этой остановки 
+			size_t vertex_count = tc.GetStops().size();
+			size_t edge_count = 0;
+			for (const domain::Bus& bus : buses_) {
+				const size_t directions = bus.type == "true" ? 1 : 2;
+				vertex_count += directions * bus.stops.size();
+				edge_count += bus.stops.empty() ? 0 : directions * 3 * (bus.stops.size() - 1);
+			}
+			graph_ = DirectedWeightedGraph<RouteWeight>(vertex_count);
+			graph_.ReserveEdges(edge_count);
 
-					int span_count = std::distance(stops.begin(), std::next(it_inner)) - std::distance(stops.begin(), it);
+			VertexId first_vertex = tc.GetStops().size();
+			for (const domain::Bus& bus : buses_) {
+				AddLineDirection(bus.stops, bus.distances, bus.id, first_vertex);
+				first_vertex += bus.stops.size();
+				if (bus.type != "true") {
+					const std::vector<uint32_t> reversed_stops(bus.stops.rbegin(), bus.stops.rend());
+					AddLineDirection(reversed_stops, bus.return_distances, bus.id, first_vertex);
+					first_vertex += bus.stops.size();
+				}
+			}
+			IndexStopVertices(1);
+		}
 
-					Edge<double>* edge_go_wait_inner = new Edge<double>{ num_vertex1_go, num_vertex_inner_next_wait , time_min_1_2, bus_name, span_count };
+		void ActivityProcessor::AddLineDirection(const std::vector<uint32_t>& stops, const std::vector<int>& distances,
+			uint32_t bus_id, VertexId first_vertex) {
+			// На каждой позиции маршрута: посадка с ожиданием, проезд до следующей позиции и высадка.
+			// Поездка на несколько остановок складывается из проездов во время поиска
+			for (size_t i = 0; i < stops.size(); ++i) {
+				const uint32_t stop_id = stops[i];
 
-					graph_.AddEdge(*edge_go_wait_inner);
-					sum_time = time_min_1_2; // присваиваю значение накопленного времени - текущее потраченное время 
+				if (i > 0) {
+					AddWeightedEdge({ first_vertex + i, stop_id, RouteWeight{}, NO_ACTIVITY_ID, 0, 0, 0 });
+				}
+				if (i + 1 < stops.size()) {
+					const int distance = distances[i];
 
+					AddWeightedEdge({ stop_id, first_vertex + i, RouteWeight{}, stop_id, 0, 0, 1 });
+					AddWeightedEdge({ first_vertex + i, first_vertex + i + 1, RouteWeight{}, bus_id, 1, distance, 0 });
 				}
 			}
-
 		}
 
-
-		void ActivityProcessor::AddStopsNonRoundTrip(std::deque<std::string_view> stops, const std::string& bus_name) {  // Тут если передать stops по константной ссылке то ошибка в utility
-			AddStopsOneDirection(stops, bus_name); // Заполняю в прямом направлении
-			std::reverse(stops.begin(), stops.end()); // разворачияю списов остановок 
-			AddStopsOneDirection(stops, bus_name); // Заполняю в обратном направлении
+		void ActivityProcessor::AddStopsNonRoundTrip(const domain::Bus& bus) {
+			AddStopsOneDirection(bus.stops, bus.distances, bus.id); // Заполняю в прямом направлении
+			const std::vector<uint32_t> reversed_stops(bus.stops.rbegin(), bus.stops.rend()); // разворачиваю список остановок 
+			AddStopsOneDirection(reversed_stops, bus.return_distances, bus.id); // Заполняю в обратном направлении
 
 		}
 	
@@ -1,8 +1,17 @@
 
 #pragma once
 #include "router.h"
+#include "dijkstra_router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "landmarks.h"
+#include "raptor_router.h"
 #include "transport_catalogue.h"
 
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <variant>
 #include <memory>
 
@@ -22,36 +31,167 @@ namespace graph {
 		double time;
 	};
 
+#ifdef TC_FIXED_POINT_WEIGHTS
+	// Веса рёбер и маршрутов - целые десятые доли секунды (сборка с -DTC_FIXED_POINT_WEIGHTS=ON):
+	// вдвое меньше памяти на вес и одинаковые результаты на любой платформе
+	using RouteWeight = uint32_t;
+	inline constexpr double ROUTE_WEIGHT_PER_MINUTE = 600.0;
+#else
+	// Веса рёбер и маршрутов - минуты
+	using RouteWeight = double;
+	inline constexpr double ROUTE_WEIGHT_PER_MINUTE = 1.0;
+#endif
+
+	inline RouteWeight ToRouteWeight(double minutes) {
+		if constexpr (std::is_integral_v<RouteWeight>) {
+			return static_cast<RouteWeight>(std::llround(minutes * ROUTE_WEIGHT_PER_MINUTE));
+		}
+		else {
+			return minutes;
+		}
+	}
+
+	// Веса переводятся в минуты только для ответа
+	inline double ToMinutes(RouteWeight weight) {
+		return weight / ROUTE_WEIGHT_PER_MINUTE;
+	}
+
+	// Вес ребра при заданных скорости автобуса и времени ожидания
+	inline RouteWeight ComputeEdgeWeight(const Edge<RouteWeight>& edge, const domain::RouteWeightParameters& parameters) {
+		return ToRouteWeight(edge.wait_count * parameters.bus_wait_time + edge.distance / (parameters.bus_velocity * 1000 / 60));
+	}
+
+	// name_id ребра высадки из автобуса на остановку в модели LINE_SEGMENTS: в ответе такое ребро не выводится
+	inline constexpr uint32_t NO_ACTIVITY_ID = std::numeric_limits<uint32_t>::max();
+
 	struct DestinatioInfo { // такое название потому что RouteInfo уже используется в router 
 		std::vector<std::variant<BusActivity, WaitingActivity>> route;
 		double all_time=0.0;
 	};
 
+	// Остановка в ответе на Isochrone: время в пути до неё в минутах
+	struct ReachableStop {
+		std::string_view stop_name;
+		double time;
+	};
+
+	// Таблица маршрутизатора PRECOMPUTED в одном из вариантов хранения весов
+	// или предрасчёт маршрутизаторов CONTRACTION_HIERARCHIES и ALT
+	using RoutesTable = std::variant<std::monostate,
+		Router<RouteWeight>::RoutesInternalData,
+		Router<RouteWeight, float>::RoutesInternalData,
+		ContractionHierarchy<RouteWeight>::Hierarchy,
+		LandmarkTables<RouteWeight>>;
+
+	// Рассчитанные при make_base данные маршрутизации, которые сохраняются в базе
+	struct RoutingData {
+		DirectedWeightedGraph<RouteWeight> graph;
+		std::unordered_map<std::string_view, size_t> stop_to_vertex;
+		RoutesTable routes_table;
+	};
+
+	// Маршрутизаторы хранят буферы поиска и кэши между запросами, поэтому ActivityProcessor
+	// не потокобезопасен даже в константных методах: каждому потоку - свой экземпляр
+	// над общим замороженным справочником
 	class ActivityProcessor {
 
 	public:
-		ActivityProcessor(transport_catalogue::TransportCatalogue& tc);
+		// Строит граф и маршрутизатор по справочнику
+		ActivityProcessor(const transport_catalogue::TransportCatalogue& tc);
+		// Восстанавливает граф и маршрутизатор из базы без перерасчёта
+		ActivityProcessor(const transport_catalogue::TransportCatalogue& tc, RoutingData routing_data);
 
 		void AddKnots();
 
-		std::optional<DestinatioInfo> GetRouteAndBuses(std::string_view stop_name_from, std::string_view stop_name_to);
+		// Необязательные parameters заменяют скорость и время ожидания из настроек базы. Веса
+		// рёбер под них пересчитываются без перестроения графа, а поиск идёт Дейкстрой по тому
+		// же графу: таблицы PRECOMPUTED, CONTRACTION_HIERARCHIES и ALT посчитаны для весов базы
+		std::optional<DestinatioInfo> GetRouteAndBuses(std::string_view stop_name_from, std::string_view stop_name_to,
+			const std::optional<domain::RouteWeightParameters>& parameters = std::nullopt);
+
+		// Матрица маршрутов origins x destinations. Для поисков по графу - одно дерево кратчайших
+		// путей на остановку отправления вместо поиска на каждую пару. Без with_itineraries
+		// в ответе заполняется только all_time
+		std::vector<std::vector<std::optional<DestinatioInfo>>> GetRouteMatrix(const std::vector<std::string>& origins,
+			const std::vector<std::string>& destinations, bool with_itineraries,
+			const std::optional<domain::RouteWeightParameters>& parameters = std::nullopt);
+
+		// Остановки, до которых от stop_name_from можно добраться не дольше max_time минут,
+		// по возрастанию времени. Один поиск Дейкстры, ограниченный max_time, независимо от
+		// выбранного маршрутизатора (для RAPTOR - его раунды с той же границей).
+		// nullopt, если остановка не участвует в маршрутах; отрицательное max_time - invalid_argument
+		std::optional<std::vector<ReachableStop>> GetIsochrone(std::string_view stop_name_from, double max_time,
+			const std::optional<domain::RouteWeightParameters>& parameters = std::nullopt);
+
+		const DirectedWeightedGraph<RouteWeight>& GetGraph() const;
+		const std::unordered_map<std::string_view, size_t>& GetStopToVertex() const;
+		// nullptr для маршрутизатора RAPTOR, которому граф не нужен
+		const RouterBase<RouteWeight>* GetRouter() const;
+		// nullptr, если маршрутизатор не ALT
+		const LandmarkTables<RouteWeight>* GetLandmarks() const;
+		// Попадания и промахи кэша деревьев кратчайших путей; nullptr, если кэш выключен
+		const ShortestPathTreeCacheStats* GetTreeCacheStats() const;
 
 	private:
-		transport_catalogue::TransportCatalogue& tc;
-		DirectedWeightedGraph<double> graph_;
+		const transport_catalogue::TransportCatalogue& tc;
+		DirectedWeightedGraph<RouteWeight> graph_;
 		std::unordered_map<std::string_view, size_t> stop_to_vertex_;
-		std::unique_ptr<graph::Router<double>> router_;
+		std::unique_ptr<graph::RouterBase<RouteWeight>> router_;
+		std::unique_ptr<graph::RaptorRouter> raptor_router_;
+		std::optional<LandmarkTables<RouteWeight>> landmarks_;
+		std::unique_ptr<ShortestPathTreeCache<RouteWeight>> tree_cache_;
+		// Поиск по графу целиком для RouteMatrix и Isochrone, создаётся при первом запросе
+		std::unique_ptr<DijkstraRouter<RouteWeight>> tree_router_;
+		std::vector<std::optional<std::string_view>> vertex_to_stop_;
+
+		// Поиск с весами под параметры из запроса; хранится для последних параметров
+		struct ParametricRouter {
+			domain::RouteWeightParameters parameters;
+			std::unique_ptr<DijkstraRouter<RouteWeight>> router;
+		};
+		std::optional<ParametricRouter> parametric_router_;
+
 
 
 
+		void CreateRouter();
+
+		// Поиск Дейкстры или A* с очередью из настроек маршрутизации
+		std::unique_ptr<RouterBase<RouteWeight>> MakeDijkstraRouter(DijkstraRouter<RouteWeight>::Potential potential);
+		// Оценка для A*: расстояние по прямой до цели, умноженное на наименьшее время
+		// на метр прямой среди рёбер графа
+		DijkstraRouter<RouteWeight>::Potential MakeGeoPotential() const;
+		void CreateLandmarkRouter(LandmarkTables<RouteWeight> landmarks);
+
+		const DijkstraRouter<RouteWeight>& GetTreeRouter();
+		// Поиск по всему графу для parameters: GetTreeRouter, если они совпадают с настройками базы
+		const DijkstraRouter<RouteWeight>& GetTreeRouter(const domain::RouteWeightParameters& parameters);
+
+		// Ребро с весом для настроек базы
+		void AddWeightedEdge(Edge<RouteWeight> edge);
+
+		DestinatioInfo MakeDestinationInfo(const RouterBase<RouteWeight>::RouteInfo& route_info,
+			const domain::RouteWeightParameters& parameters) const;
+
+		std::optional<DestinatioInfo> GetRaptorRouteAndBuses(std::string_view stop_name_from, std::string_view stop_name_to,
+			const domain::RouteWeightParameters& parameters);
 
 		std::optional<size_t> GetValueByKey(std::string_view key);
 
 		bool ChekExistValue(std::string_view key);
 
-		void AddStopsOneDirection(const std::deque<std::string_view>& stops, const std::string& bus_name);
+		// distances[i] - расстояние от stops[i] до stops[i + 1]
+		void AddStopsOneDirection(const std::vector<uint32_t>& stops, const std::vector<int>& distances, uint32_t bus_id);
+
+		void AddStopsNonRoundTrip(const domain::Bus& bus);
+
+		// Модель LINE_SEGMENTS: вершины 0..S-1 - остановки, далее вершины позиций на направлениях маршрутов
+		void AddLineKnots();
 
+		void AddLineDirection(const std::vector<uint32_t>& stops, const std::vector<int>& distances, uint32_t bus_id,
+			VertexId first_vertex);
 
-		void AddStopsNonRoundTrip(std::deque<std::string_view> stops, const std::string& bus_name);
+		// stop_to_vertex_ для остановок маршрутов: вершина остановки id - id * vertices_per_stop
+		void IndexStopVertices(size_t vertices_per_stop);
 	};
 }
\ No newline at end of file